@@ -0,0 +1,53 @@
+#include "BatchSizer.h"
+#include <algorithm>
+
+BatchSizer::BatchSizer(const Config& config)
+    : enabled(config.mirrorSettings.autoBatchSize),
+      configuredSize(config.mirrorSettings.batchSize),
+      targetBytes(config.mirrorSettings.batchTargetBytes),
+      targetSeconds(config.mirrorSettings.batchTargetSeconds),
+      minSize(std::max(1, config.mirrorSettings.minBatchSize)),
+      maxSize(std::max(1, config.mirrorSettings.maxBatchSize)),
+      current(config.mirrorSettings.batchSize),
+      lastStats{0, 0, 0.0} {
+    lastTime = Clock::now();
+}
+
+int BatchSizer::Begin(int learnedSize, const OdbcFetchStats& stats) {
+    current = Clamp(learnedSize > 0 ? learnedSize : configuredSize);
+    lastStats = stats;
+    lastTime = Clock::now();
+    return current;
+}
+
+int BatchSizer::Next(const OdbcFetchStats& stats) {
+    Clock::time_point now = Clock::now();
+    long long rows = stats.rows - lastStats.rows;
+    long long bytes = stats.bytes - lastStats.bytes;
+    double seconds = std::chrono::duration<double>(now - lastTime).count();
+    
+    lastStats = stats;
+    lastTime = now;
+    
+    if (rows <= 0) {
+        return current;
+    }
+    
+    // Time covers the whole batch, fetch through commit, so it is the commit latency
+    double target = maxSize;
+    if (targetBytes > 0 && bytes > 0) {
+        target = std::min(target, static_cast<double>(targetBytes) * rows / bytes);
+    }
+    if (targetSeconds > 0 && seconds > 0) {
+        target = std::min(target, targetSeconds * rows / seconds);
+    }
+    
+    // Move halfway each batch; one noisy measurement should not swing the size
+    double next = (current + target) / 2;
+    current = Clamp(std::min(next, current * MAX_GROWTH));
+    return current;
+}
+
+int BatchSizer::Clamp(double size) const {
+    return static_cast<int>(std::max<double>(minSize, std::min<double>(maxSize, size)));
+}
@@ -0,0 +1,43 @@
+#ifndef BATCH_SIZER_H
+#define BATCH_SIZER_H
+
+#include <chrono>
+#include "Config.h"
+#include "OdbcHelper.h"
+
+// Sizes a table's batches from what its batches cost: enough rows to fill the byte
+// target, few enough to commit within the latency target. Starts from the size the
+// table settled on last run and adjusts at every batch boundary
+class BatchSizer {
+public:
+    explicit BatchSizer(const Config& config);
+    
+    bool Enabled() const { return enabled; }
+    
+    // Starts a table at its learned size, or the configured batch_size when it has none
+    int Begin(int learnedSize, const OdbcFetchStats& stats);
+    
+    // Called at a batch boundary with the source totals; returns the next batch size
+    int Next(const OdbcFetchStats& stats);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    bool enabled;
+    int configuredSize;
+    long long targetBytes;
+    double targetSeconds;
+    int minSize;
+    int maxSize;
+    
+    int current;
+    OdbcFetchStats lastStats;
+    Clock::time_point lastTime;
+    
+    // Growth per step is capped so one fast batch after a slow start cannot overshoot
+    static constexpr double MAX_GROWTH = 2.0;
+    
+    int Clamp(double size) const;
+};
+
+#endif // BATCH_SIZER_H
@@ -1,4 +1,21 @@
 #include "Config.h"
+#include <algorithm>
+#include <set>
+
+// Table and column names are matched lowercase throughout
+static std::string ToLower(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(),
+                  [](unsigned char c) { return std::tolower(c); });
+    return name;
+}
+
+static std::vector<std::string> ToLowerList(const nlohmann::json& names) {
+    std::vector<std::string> result;
+    for (const auto& name : names) {
+        result.push_back(ToLower(name.get<std::string>()));
+    }
+    return result;
+}
 
 Config::Config(const std::string& configFile) {
     LoadConfig(configFile);
@@ -12,7 +29,26 @@ void Config::LoadConfig(const std::string& configFile) {
 
     nlohmann::json config;
     file >> config;
+    
+    Load(config);
+}
+
+Config Config::ForSource(const SourceConfig& source) const {
+    Config sourceConfig(*this);
+    sourceConfig.sources.clear();
+    sourceConfig.LoadSettings(source.settings);
+    return sourceConfig;
+}
 
+void Config::Load(const nlohmann::json& config) {
+    LoadSources(config);
+    
+    // With sources the top level only holds defaults, which may be incomplete; the settings
+    // then read as the first source's, and every source gets its own copy from ForSource
+    LoadSettings(sources.empty() ? config : sources[0].settings);
+}
+
+void Config::LoadSettings(nlohmann::json config) {
     progressDb.host = config["progress_db"]["host"];
     progressDb.port = config["progress_db"]["port"];
     progressDb.dbName = config["progress_db"]["db_name"];
@@ -20,18 +56,320 @@ void Config::LoadConfig(const std::string& configFile) {
     progressDb.password = config["progress_db"]["password"];
     progressDb.driverClass = config["progress_db"]["driver_class"];
     progressDb.jarFile = config["progress_db"]["jar_file"];
+    
+    if (config["progress_db"].contains("isolation_level")) {
+        progressDb.isolationLevel = config["progress_db"]["isolation_level"];
+    } else {
+        progressDb.isolationLevel = "";
+    }
+    
+    if (config["progress_db"].contains("fetch_array_size")) {
+        progressDb.fetchArraySize = config["progress_db"]["fetch_array_size"];
+    } else {
+        progressDb.fetchArraySize = 0;
+    }
+    
+    if (config["progress_db"].contains("max_connections")) {
+        progressDb.maxConnections = config["progress_db"]["max_connections"];
+    } else {
+        progressDb.maxConnections = 0;
+    }
+    
+    if (config["progress_db"].contains("connection_slot_dir")) {
+        progressDb.connectionSlotDir = config["progress_db"]["connection_slot_dir"];
+    } else {
+        progressDb.connectionSlotDir = "/tmp";
+    }
 
     sqliteDb.dbPath = config["sqlite_db"]["db_path"];
     
     if (config.contains("hash_db")) {
         hashDb.dbPath = config["hash_db"]["db_path"];
         hashDb.enableHashing = config["hash_db"]["enable_hashing"];
+        
+        if (config["hash_db"].contains("column_group_size")) {
+            hashDb.columnGroupSize = config["hash_db"]["column_group_size"];
+        } else {
+            hashDb.columnGroupSize = 0;
+        }
+        
+        if (config["hash_db"].contains("rebuild_range_size")) {
+            hashDb.rebuildRangeSize = config["hash_db"]["rebuild_range_size"];
+        } else {
+            hashDb.rebuildRangeSize = 50000;
+        }
     } else {
         hashDb.dbPath = "hashes.db";
         hashDb.enableHashing = false;
+        hashDb.columnGroupSize = 0;
+        hashDb.rebuildRangeSize = 50000;
     }
 
     mirrorSettings.batchSize = config["mirror_settings"]["batch_size"];
     mirrorSettings.logFile = config["mirror_settings"]["log_file"];
     mirrorSettings.ignoreFile = config["mirror_settings"]["ignore_file"];
-}
\ No newline at end of file
+    
+    if (config["mirror_settings"].contains("hash_threads")) {
+        mirrorSettings.hashThreads = config["mirror_settings"]["hash_threads"];
+    } else {
+        mirrorSettings.hashThreads = 0;
+    }
+    
+    if (config["mirror_settings"].contains("rolling_hash_min_rows")) {
+        mirrorSettings.rollingHashMinRows = config["mirror_settings"]["rolling_hash_min_rows"];
+    } else {
+        mirrorSettings.rollingHashMinRows = 0;
+    }
+    
+    if (config["mirror_settings"].contains("verify_slices")) {
+        mirrorSettings.verifySlices = config["mirror_settings"]["verify_slices"];
+    } else {
+        mirrorSettings.verifySlices = 30;
+    }
+    
+    if (config["mirror_settings"].contains("fingerprint_bucket_rows")) {
+        mirrorSettings.fingerprintBucketRows = config["mirror_settings"]["fingerprint_bucket_rows"];
+    } else {
+        mirrorSettings.fingerprintBucketRows = 0;
+    }
+    
+    if (config["mirror_settings"].contains("skip_unchanged_tables")) {
+        mirrorSettings.skipUnchangedTables = config["mirror_settings"]["skip_unchanged_tables"];
+    } else {
+        mirrorSettings.skipUnchangedTables = false;
+    }
+    
+    if (config["mirror_settings"].contains("timestamp_overlap_seconds")) {
+        mirrorSettings.timestampOverlapSeconds = config["mirror_settings"]["timestamp_overlap_seconds"];
+    } else {
+        mirrorSettings.timestampOverlapSeconds = 60;
+    }
+    
+    if (config["mirror_settings"].contains("rowid_keys")) {
+        mirrorSettings.rowidKeys = config["mirror_settings"]["rowid_keys"];
+    } else {
+        mirrorSettings.rowidKeys = false;
+    }
+    
+    if (config["mirror_settings"].contains("reconnect_attempts")) {
+        mirrorSettings.reconnectAttempts = config["mirror_settings"]["reconnect_attempts"];
+    } else {
+        mirrorSettings.reconnectAttempts = 5;
+    }
+    
+    if (config["mirror_settings"].contains("reconnect_delay_seconds")) {
+        mirrorSettings.reconnectDelaySeconds = config["mirror_settings"]["reconnect_delay_seconds"];
+    } else {
+        mirrorSettings.reconnectDelaySeconds = 2;
+    }
+    
+    if (config["mirror_settings"].contains("adaptive_strategy")) {
+        mirrorSettings.adaptiveStrategy = config["mirror_settings"]["adaptive_strategy"];
+    } else {
+        mirrorSettings.adaptiveStrategy = false;
+    }
+    
+    if (config["mirror_settings"].contains("full_reload_change_ratio")) {
+        mirrorSettings.fullReloadChangeRatio = config["mirror_settings"]["full_reload_change_ratio"];
+    } else {
+        mirrorSettings.fullReloadChangeRatio = 0.3;
+    }
+    
+    if (config["mirror_settings"].contains("adaptive_verify_every")) {
+        mirrorSettings.adaptiveVerifyEvery = config["mirror_settings"]["adaptive_verify_every"];
+    } else {
+        mirrorSettings.adaptiveVerifyEvery = 10;
+    }
+    
+    if (config["mirror_settings"].contains("sync_interval_seconds")) {
+        mirrorSettings.syncIntervalSeconds = config["mirror_settings"]["sync_interval_seconds"];
+    } else {
+        mirrorSettings.syncIntervalSeconds = 3600;
+    }
+    
+    if (config["mirror_settings"].contains("max_idle_backoff")) {
+        mirrorSettings.maxIdleBackoff = config["mirror_settings"]["max_idle_backoff"];
+    } else {
+        mirrorSettings.maxIdleBackoff = 8;
+    }
+    
+    if (config["mirror_settings"].contains("table_refresh_seconds")) {
+        mirrorSettings.tableRefreshSeconds = config["mirror_settings"]["table_refresh_seconds"];
+    } else {
+        mirrorSettings.tableRefreshSeconds = 3600;
+    }
+    
+    if (config["mirror_settings"].contains("cdc_enabled")) {
+        mirrorSettings.cdcEnabled = config["mirror_settings"]["cdc_enabled"];
+    } else {
+        mirrorSettings.cdcEnabled = false;
+    }
+    
+    if (config["mirror_settings"].contains("cdc_schema")) {
+        mirrorSettings.cdcSchema = config["mirror_settings"]["cdc_schema"];
+    } else {
+        mirrorSettings.cdcSchema = "PUB";
+    }
+    
+    if (config["mirror_settings"].contains("cdc_table_prefix")) {
+        mirrorSettings.cdcTablePrefix = config["mirror_settings"]["cdc_table_prefix"];
+    } else {
+        mirrorSettings.cdcTablePrefix = "CDC_";
+    }
+    
+    if (config["mirror_settings"].contains("cdc_sequence_column")) {
+        mirrorSettings.cdcSequenceColumn = config["mirror_settings"]["cdc_sequence_column"];
+    } else {
+        mirrorSettings.cdcSequenceColumn = "_Change-Sequence";
+    }
+    
+    if (config["mirror_settings"].contains("cdc_operation_column")) {
+        mirrorSettings.cdcOperationColumn = config["mirror_settings"]["cdc_operation_column"];
+    } else {
+        mirrorSettings.cdcOperationColumn = "_Operation";
+    }
+    
+    if (config["mirror_settings"].contains("cdc_refetch_rows")) {
+        mirrorSettings.cdcRefetchRows = config["mirror_settings"]["cdc_refetch_rows"];
+    } else {
+        mirrorSettings.cdcRefetchRows = false;
+    }
+    
+    if (config["mirror_settings"].contains("key_fetch_chunk")) {
+        mirrorSettings.keyFetchChunk = config["mirror_settings"]["key_fetch_chunk"];
+    } else {
+        mirrorSettings.keyFetchChunk = 1000;
+    }
+    
+    if (config["mirror_settings"].contains("max_rows_per_second")) {
+        mirrorSettings.maxRowsPerSecond = config["mirror_settings"]["max_rows_per_second"];
+    } else {
+        mirrorSettings.maxRowsPerSecond = 0;
+    }
+    
+    if (config["mirror_settings"].contains("max_bytes_per_second")) {
+        mirrorSettings.maxBytesPerSecond = config["mirror_settings"]["max_bytes_per_second"];
+    } else {
+        mirrorSettings.maxBytesPerSecond = 0;
+    }
+    
+    if (config["mirror_settings"].contains("adaptive_throttle")) {
+        mirrorSettings.adaptiveThrottle = config["mirror_settings"]["adaptive_throttle"];
+    } else {
+        mirrorSettings.adaptiveThrottle = false;
+    }
+    
+    if (config["mirror_settings"].contains("throttle_latency_ratio")) {
+        mirrorSettings.throttleLatencyRatio = config["mirror_settings"]["throttle_latency_ratio"];
+    } else {
+        mirrorSettings.throttleLatencyRatio = 2.0;
+    }
+    
+    if (config["mirror_settings"].contains("auto_batch_size")) {
+        mirrorSettings.autoBatchSize = config["mirror_settings"]["auto_batch_size"];
+    } else {
+        mirrorSettings.autoBatchSize = false;
+    }
+    
+    if (config["mirror_settings"].contains("batch_target_bytes")) {
+        mirrorSettings.batchTargetBytes = config["mirror_settings"]["batch_target_bytes"];
+    } else {
+        mirrorSettings.batchTargetBytes = 8 * 1024 * 1024;
+    }
+    
+    if (config["mirror_settings"].contains("batch_target_seconds")) {
+        mirrorSettings.batchTargetSeconds = config["mirror_settings"]["batch_target_seconds"];
+    } else {
+        mirrorSettings.batchTargetSeconds = 2.0;
+    }
+    
+    if (config["mirror_settings"].contains("min_batch_size")) {
+        mirrorSettings.minBatchSize = config["mirror_settings"]["min_batch_size"];
+    } else {
+        mirrorSettings.minBatchSize = 100;
+    }
+    
+    if (config["mirror_settings"].contains("max_batch_size")) {
+        mirrorSettings.maxBatchSize = config["mirror_settings"]["max_batch_size"];
+    } else {
+        mirrorSettings.maxBatchSize = 100000;
+    }
+    
+    if (config["mirror_settings"].contains("max_concurrent_tables")) {
+        mirrorSettings.maxConcurrentTables = config["mirror_settings"]["max_concurrent_tables"];
+    } else {
+        mirrorSettings.maxConcurrentTables = 0;
+    }
+    
+    tables.clear();
+    if (config.contains("tables")) {
+        for (auto& entry : config["tables"].items()) {
+            std::string tableName = entry.key();
+            std::transform(tableName.begin(), tableName.end(), tableName.begin(),
+                          [](unsigned char c) { return std::tolower(c); });
+            
+            const auto& tableConfig = entry.value();
+            TableSettings settings;
+            settings.verifySlices = tableConfig.contains("verify_slices") ? tableConfig["verify_slices"].get<int>() : 0;
+            settings.verifySliceRows = tableConfig.contains("verify_slice_rows") ? tableConfig["verify_slice_rows"].get<int>() : 0;
+            settings.fingerprintBucketRows = tableConfig.contains("fingerprint_bucket_rows") ? tableConfig["fingerprint_bucket_rows"].get<int>() : -1;
+            settings.syncIntervalSeconds = tableConfig.contains("sync_interval_seconds") ? tableConfig["sync_interval_seconds"].get<int>() : 0;
+            settings.importance = tableConfig.contains("importance") ? tableConfig["importance"].get<double>() : 1.0;
+            settings.cdcTable = tableConfig.contains("cdc_table") ? tableConfig["cdc_table"].get<std::string>() : "";
+            settings.isolationLevel = tableConfig.contains("isolation_level") ? tableConfig["isolation_level"].get<std::string>() : "";
+            settings.columns = tableConfig.contains("columns") ? ToLowerList(tableConfig["columns"]) : std::vector<std::string>();
+            settings.excludeColumns = tableConfig.contains("exclude_columns") ? ToLowerList(tableConfig["exclude_columns"]) : std::vector<std::string>();
+            settings.dropExcludedColumns = tableConfig.contains("drop_excluded_columns") ? tableConfig["drop_excluded_columns"].get<bool>() : false;
+            settings.where = tableConfig.contains("where") ? tableConfig["where"].get<std::string>() : "";
+            settings.keyColumns = tableConfig.contains("key_columns") ? ToLowerList(tableConfig["key_columns"]) : std::vector<std::string>();
+            settings.timestampColumn = tableConfig.contains("timestamp_column") ? ToLower(tableConfig["timestamp_column"].get<std::string>()) : "";
+            settings.strategy = tableConfig.contains("strategy") ? tableConfig["strategy"].get<std::string>() : "";
+            settings.batchSize = tableConfig.contains("batch_size") ? tableConfig["batch_size"].get<int>() : 0;
+            tables[tableName] = settings;
+        }
+    }
+}
+
+void Config::LoadSources(const nlohmann::json& config) {
+    sources.clear();
+    if (!config.contains("sources")) {
+        return;
+    }
+    
+    std::set<std::string> names;
+    std::set<std::string> mirrors;
+    std::set<std::string> hashDbs;
+    
+    for (const auto& sourceConfig : config["sources"]) {
+        SourceConfig source;
+        source.name = sourceConfig.at("name").get<std::string>();
+        
+        // Sections a source leaves out, or only partly sets, come from the top level
+        source.settings = config;
+        source.settings.erase("sources");
+        for (const char* section : {"progress_db", "sqlite_db", "hash_db", "tables"}) {
+            if (sourceConfig.contains(section)) {
+                source.settings[section].merge_patch(sourceConfig[section]);
+            }
+        }
+        if (sourceConfig.contains("ignore_file")) {
+            source.settings["mirror_settings"]["ignore_file"] = sourceConfig["ignore_file"];
+        }
+        
+        // Sources run side by side, so each needs a mirror and hash database of its own
+        std::string mirror = source.settings.at("sqlite_db").at("db_path").get<std::string>();
+        std::string hashDbPath = source.settings.contains("hash_db") ? 
+            source.settings["hash_db"].at("db_path").get<std::string>() : "hashes.db";
+        if (!names.insert(source.name).second) {
+            throw std::runtime_error("Source name " + source.name + " is used twice");
+        }
+        if (!mirrors.insert(mirror).second) {
+            throw std::runtime_error("Source " + source.name + " shares mirror " + mirror + " with another source");
+        }
+        if (!hashDbs.insert(hashDbPath).second) {
+            throw std::runtime_error("Source " + source.name + " shares hash database " + hashDbPath + " with another source");
+        }
+        
+        sources.push_back(source);
+    }
+}
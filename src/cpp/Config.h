@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <stdexcept>
@@ -18,6 +19,11 @@ public:
         std::string driverClass;
         std::string jarFile;
         std::string dsn; 
+        std::string isolationLevel; // read_uncommitted (or nolock), read_committed, repeatable_read,
+                                    // serializable; empty keeps the driver default
+        int fetchArraySize;     // Rows the driver prefetches per round trip; 0 = driver default
+        int maxConnections;     // Connections to this server across all mirror processes; 0 = no cap
+        std::string connectionSlotDir; // Where the lock files enforcing maxConnections live
     };
 
     struct SQLiteConfig {
@@ -27,23 +33,90 @@ public:
     struct HashDbConfig {
         std::string dbPath;
         bool enableHashing;
+        int columnGroupSize;    // Columns per stored digest for partial UPDATEs; 0 = off
+        int rebuildRangeSize;   // Mirror rows per work unit for --rebuild-hashes
     };
 
     struct MirrorSettings {
         int batchSize;
         std::string logFile;
         std::string ignoreFile;
+        int hashThreads;        // Hash worker pool size; 0 = one per hardware thread
+        int rollingHashMinRows; // Tables at least this large use rolling verification; 0 = off
+        int verifySlices;       // Default runs per full rolling verification pass
+        int fingerprintBucketRows; // Key-range size for fingerprint-skipping hash syncs; 0 = off
+        bool skipUnchangedTables;  // Skip tables whose _TableStat write counters have not moved
+        int timestampOverlapSeconds; // Re-read window below the timestamp high-water mark
+        bool rowidKeys;         // Key tables with no usable key on ROWID, mirrored into _oe_rowid
+        int reconnectAttempts;  // Reconnects, and replays of an interrupted table, before giving up
+        int reconnectDelaySeconds; // First backoff delay; doubles per attempt
+        bool adaptiveStrategy;  // Let recorded run history override the hash strategies
+        double fullReloadChangeRatio; // Changed share of rows above which a reload is chosen
+        int adaptiveVerifyEvery; // Runs between forced runs of the configured strategy
+        int syncIntervalSeconds; // --daemon: default target freshness per table
+        int maxIdleBackoff;     // --daemon: interval multiplier cap for tables that keep not changing
+        int tableRefreshSeconds; // --daemon: how often the table list and metadata are rediscovered
+        bool cdcEnabled;        // Sync tables with an OpenEdge CDC change table from it
+        std::string cdcSchema;  // Schema holding the change tables
+        std::string cdcTablePrefix; // Change table name is prefix + source table name
+        std::string cdcSequenceColumn;
+        std::string cdcOperationColumn;
+        bool cdcRefetchRows;    // Change tables carry only the key; current rows are fetched from the source
+        int keyFetchChunk;      // Keys per lookup statement when fetching rows by key
+        long long maxRowsPerSecond;  // Source read caps; 0 = uncapped
+        long long maxBytesPerSecond;
+        bool adaptiveThrottle;  // Slow reads down while fetch latency is above its baseline
+        double throttleLatencyRatio; // Latency over baseline at which adaptive mode backs off
+        bool autoBatchSize;     // Tune batch_size per table from measured batches; learned sizes persist
+        long long batchTargetBytes; // Source bytes a tuned batch aims for
+        double batchTargetSeconds;  // Fetch-to-commit time a tuned batch aims for
+        int minBatchSize;
+        int maxBatchSize;
+        int maxConcurrentTables; // Tables synced at once across all sources; 0 = one per source
     };
 
+    // Per-table overrides, keyed by lowercase table name
+    struct TableSettings {
+        int verifySlices;       // Runs per full verification pass; 0 = use default
+        int verifySliceRows;    // Rows verified per run; overrides verifySlices when set
+        int fingerprintBucketRows; // -1 = use default, 0 = off
+        int syncIntervalSeconds; // --daemon target freshness; 0 = use default
+        double importance;      // --time-budget weight on staleness; default 1
+        std::string cdcTable;   // Change table name when it does not follow cdc_table_prefix
+        std::string isolationLevel; // Source isolation while this table is read; empty = use default
+        std::vector<std::string> columns;        // Columns to read; empty = all
+        std::vector<std::string> excludeColumns; // Columns never read, e.g. large unused text
+        bool dropExcludedColumns; // Drop excluded columns an existing mirror table still has; kept by default
+        std::string where;      // Source filter added to every SELECT; rows outside it are not mirrored
+        std::vector<std::string> keyColumns; // Key override for tables without a usable key
+        std::string timestampColumn; // Incremental column override
+        std::string strategy;   // Forced strategy; empty = chosen per run
+        int batchSize;          // 0 = use default
+    };
+    
+    // One of several OpenEdge databases mirrored by the same process
+    struct SourceConfig {
+        std::string name;       // Tags the source's log lines
+        nlohmann::json settings; // The whole config with the source's sections patched over the top level
+    };
+    
     Config(const std::string& configFile = "config.json");
-
+    
+    // This config as seen by one source: its connection, mirror, hashes, ignore list and tables
+    Config ForSource(const SourceConfig& source) const;
+    
     DatabaseConfig progressDb;
     SQLiteConfig sqliteDb;
     HashDbConfig hashDb;
     MirrorSettings mirrorSettings;
+    std::map<std::string, TableSettings> tables;
+    std::vector<SourceConfig> sources; // Empty when the top-level progress_db is the only source
 
 private:
     void LoadConfig(const std::string& configFile);
+    void Load(const nlohmann::json& config);
+    void LoadSettings(nlohmann::json config);
+    void LoadSources(const nlohmann::json& config);
 };
 
 #endif
\ No newline at end of file
@@ -1,17 +1,40 @@
 #include "DataSyncManager.h"
+#include "HashRebuilder.h"
+#include "QueryPlanner.h"
+#include "KeyCodec.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <queue>
+#include <limits>
+#include <csignal>
 
-DataSyncManager::DataSyncManager(const std::string& configFile, bool fullSync, const std::vector<std::string>& ignoreTables)
-    : configFile(configFile), fullSync(fullSync) {
-    
-    config = Config(configFile);
+// Set from SIGINT/SIGTERM; the daemon finishes its current table and exits
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void HandleStopSignal(int) {
+    stopRequested = 1;
+}
+
+DataSyncManager::DataSyncManager(const Config& config, bool fullSync, const std::vector<std::string>& ignoreTables,
+                                 int timeBudgetSeconds, std::shared_ptr<Logger> logger,
+                                 std::shared_ptr<HashWorkerPool> hashPool,
+                                 std::shared_ptr<SyncScheduler> scheduler)
+    : config(config), fullSync(fullSync), timeBudgetSeconds(timeBudgetSeconds), logger(logger),
+      hashPool(hashPool), scheduler(scheduler) {
     
-    logger = std::make_shared<Logger>(config.mirrorSettings.logFile);
+    if (!this->logger) {
+        this->logger = std::make_shared<Logger>(config.mirrorSettings.logFile);
+    }
     
     metrics.tablesProcessed = 0;
+    metrics.tablesSkipped = 0;
+    metrics.tablesDeferred = 0;
     metrics.rowsSynced = 0;
+    metrics.reconnects = 0;
+    metrics.slotWaitSeconds = 0;
     metrics.startTime = time(nullptr);
     
     LoadIgnoreList();
@@ -25,85 +48,422 @@ DataSyncManager::~DataSyncManager() {
     // Proper destruction order is handled by smart pointers
 }
 
+void DataSyncManager::InstallStopHandlers() {
+    stopRequested = 0;
+    std::signal(SIGINT, HandleStopSignal);
+    std::signal(SIGTERM, HandleStopSignal);
+}
+
 void DataSyncManager::RunSync() {
     logger->Info("Starting data sync (fullSync=" + std::string(fullSync ? "true" : "false") + ")");
     
     metrics.startTime = time(nullptr);
     
     try {
-        // Initialize database connector
-        dbConnector = std::make_unique<DatabaseConnector>(config, logger);
-        
-        if (!dbConnector->Connect()) {
-            logger->Error("Failed to connect to databases");
+        if (!Initialize()) {
             return;
         }
         
-        // Initialize helpers
-        sqliteHelper = std::make_unique<SqliteHelper>(dbConnector->GetSqliteConnection(), logger);
-        odbcHelper = std::make_unique<OdbcHelper>(dbConnector->GetOdbcConnection(), dbConnector->GetOdbcEnvironment(), logger);
-        
-        // Initialize state tracking
-        syncState = std::make_shared<SyncState>(dbConnector->GetSqliteConnection(), logger);
+        LoadTableActivity();
         
-        // Initialize hash database if enabled
-        if (config.hashDb.enableHashing) {
-            hashDb = std::make_shared<HashStorage>(config.hashDb.dbPath, logger);
-            if (!hashDb->Initialize()) {
-                logger->Error("Failed to initialize hash database");
-                hashDb.reset();
-            } else {
-                logger->Info("Hash database initialized successfully");
-            }
+        // Get tables to sync
+        auto tables = GetSourceTables(true);
+        if (tables.empty() && metrics.tablesSkipped > 0) {
+            logger->Info("All " + std::to_string(metrics.tablesSkipped) + " tables unchanged since their last sync");
+            return;
         }
         
-        // Create table syncer
-        tableSyncer = std::make_unique<TableSyncer>(
-            *sqliteHelper,
-            *odbcHelper,
-            syncState,
-            hashDb,
-            logger,
-            config.mirrorSettings.batchSize
-        );
-        
-        // Get tables to sync
-        auto tables = GetSourceTables();
         if (tables.empty()) {
             logger->Error("No tables found to sync");
             return;
         }
         
         logger->Info("Found " + std::to_string(tables.size()) + " tables to sync");
+        if (metrics.tablesSkipped > 0) {
+            logger->Info("Skipped " + std::to_string(metrics.tablesSkipped) + " tables without writes since their last sync");
+        }
+        
+        auto plan = PlanTables(tables);
+        std::vector<std::string> deferredTables;
         
         // Process each table
         int tableIndex = 1;
-        for (const auto& tableInfo : tables) {
+        for (const auto& planned : plan) {
+            const TableInfo& tableInfo = planned.tableInfo;
+            
+            // A table that cannot finish inside the budget waits for the next run, where it goes first.
+            // The first table always starts, so one larger than the whole budget is not starved
+            if (timeBudgetSeconds > 0) {
+                double remaining = timeBudgetSeconds - difftime(time(nullptr), metrics.startTime);
+                if (planned.predictedSeconds > remaining && metrics.tablesProcessed > 0) {
+                    syncState->SetDeferred(tableInfo.tableName, true);
+                    deferredTables.push_back(tableInfo.tableName);
+                    metrics.tablesDeferred++;
+                    tableIndex++;
+                    continue;
+                }
+            }
+            
             logger->Info("Processing table " + std::to_string(tableIndex) + "/" + 
                         std::to_string(tables.size()) + ": " + tableInfo.tableName);
             
-            try {
-                int rows = tableSyncer->SyncTable(tableInfo, fullSync);
-                
-                metrics.tablesProcessed++;
-                metrics.rowsSynced += rows;
-            } catch (const std::exception& e) {
-                logger->Error("Error syncing table " + tableInfo.tableName + ": " + e.what());
+            // A link that died while idle is replaced before the table starts
+            if (odbcHelper->ConnectionLost() || odbcHelper->IsConnectionDead()) {
+                if (!RecoverConnection(0)) {
+                    logger->Error("OpenEdge connection could not be restored; " + 
+                                 std::to_string(tables.size() - tableIndex + 1) + " tables were not synced");
+                    break;
+                }
+            }
+            
+            bool connectionUsable = true;
+            SyncTrackedTable(tableInfo, fullSync, planned.score, connectionUsable);
+            
+            if (planned.deferredRuns > 0) {
+                syncState->SetDeferred(tableInfo.tableName, false);
+            }
+            
+            if (!connectionUsable) {
+                if (static_cast<size_t>(tableIndex) < tables.size()) {
+                    logger->Error("OpenEdge connection could not be restored; " +
+                                 std::to_string(tables.size() - tableIndex) + " remaining tables were not synced");
+                }
+                break;
             }
             
             tableIndex++;
         }
         
-        double duration = difftime(time(nullptr), metrics.startTime);
-        logger->Info("Sync completed in " + std::to_string(duration) + " seconds");
-        logger->Info("Processed " + std::to_string(metrics.tablesProcessed) + " tables");
-        logger->Info("Synced " + std::to_string(metrics.rowsSynced) + " rows");
+        if (!deferredTables.empty()) {
+            std::string names;
+            for (const auto& name : deferredTables) {
+                names += (names.empty() ? "" : ", ") + name;
+            }
+            logger->Warning("Time budget of " + std::to_string(timeBudgetSeconds) + "s left " + 
+                           std::to_string(deferredTables.size()) + " tables for the next run: " + names);
+        }
         
+        LogMetrics("Sync");
+    
     } catch (const std::exception& e) {
         logger->Error("Sync process failed: " + std::string(e.what()));
     }
 }
 
+void DataSyncManager::RunDaemon() {
+    logger->Info("Starting sync daemon (fullSync=" + std::string(fullSync ? "true" : "false") + ")");
+    if (timeBudgetSeconds > 0) {
+        logger->Warning("--time-budget applies to single runs and is ignored by the daemon");
+    }
+    
+    metrics.startTime = time(nullptr);
+    
+    try {
+        // Connections, helpers and the hash pool live for the whole daemon
+        if (!Initialize()) {
+            return;
+        }
+        
+        time_t lastRefresh = 0;
+        time_t lastActivity = 0;
+        
+        while (!stopRequested) {
+            time_t now = time(nullptr);
+            
+            if (odbcHelper->ConnectionLost() || odbcHelper->IsConnectionDead()) {
+                if (!RecoverConnection(0)) {
+                    logger->Error("OpenEdge connection could not be restored; retrying in " + 
+                                 std::to_string(DAEMON_RECONNECT_SECONDS) + " seconds");
+                    SleepUntil(now + DAEMON_RECONNECT_SECONDS);
+                    continue;
+                }
+            }
+            
+            if (schedule.empty() || now - lastRefresh >= config.mirrorSettings.tableRefreshSeconds) {
+                RefreshSchedule();
+                lastRefresh = now;
+                
+                if (schedule.empty()) {
+                    logger->Error("No tables found to sync; looking again in " + 
+                                 std::to_string(config.mirrorSettings.tableRefreshSeconds) + " seconds");
+                    SleepUntil(now + config.mirrorSettings.tableRefreshSeconds);
+                    continue;
+                }
+            }
+            
+            // Most overdue relative to its own target freshness first; the queue is rebuilt
+            // after every table because relative staleness shifts as time passes
+            std::priority_queue<std::pair<double, std::string>> due;
+            time_t wakeTime = lastRefresh + config.mirrorSettings.tableRefreshSeconds;
+            for (const auto& entry : schedule) {
+                time_t dueAt = entry.second.lastSynced + GetEffectiveInterval(entry.second);
+                if (dueAt <= now) {
+                    due.push(std::make_pair(GetStaleness(entry.second, now), entry.first));
+                } else {
+                    wakeTime = std::min(wakeTime, dueAt);
+                }
+            }
+            
+            if (due.empty()) {
+                SleepUntil(wakeTime);
+                continue;
+            }
+            
+            ScheduledTable& entry = schedule[due.top().second];
+            const std::string& tableName = entry.tableInfo.tableName;
+            bool forceFull = fullSync && !entry.synced;
+            
+            logger->Info("Syncing " + tableName + " (" + std::to_string(due.size()) + " due, " + 
+                        (entry.lastSynced > 0 ? std::to_string(now - entry.lastSynced) + "s since last sync" : 
+                         std::string("never synced")) + ", interval " + std::to_string(GetEffectiveInterval(entry)) + "s)");
+            
+            // One _TableStat read serves every table that comes due within a few seconds
+            if (config.mirrorSettings.skipUnchangedTables && !forceFull && 
+                now - lastActivity >= ACTIVITY_REFRESH_SECONDS) {
+                LoadTableActivity();
+                lastActivity = now;
+            }
+            
+            int rows = 0;
+            bool connectionUsable = true;
+            if (!forceFull && IsTableUnchanged(tableName)) {
+                metrics.tablesSkipped++;
+            } else {
+                rows = SyncTrackedTable(entry.tableInfo, forceFull, GetStaleness(entry, now), connectionUsable);
+            }
+            
+            // A table cut off by the connection stays due and goes first once it is back
+            if (!connectionUsable) {
+                continue;
+            }
+            
+            entry.lastSynced = time(nullptr);
+            entry.synced = true;
+            
+            // Tables that keep coming back unchanged are polled less often, down to maxIdleBackoff
+            if (rows > 0) {
+                entry.backoff = 1;
+            } else if (entry.backoff < config.mirrorSettings.maxIdleBackoff) {
+                entry.backoff = std::min(entry.backoff * 2, std::max(1, config.mirrorSettings.maxIdleBackoff));
+                logger->Info("No changes in " + tableName + ", next sync in " + 
+                            std::to_string(GetEffectiveInterval(entry)) + "s");
+            }
+            
+            // --full-sync covers the first pass only; later passes are incremental
+            if (fullSync && std::all_of(schedule.begin(), schedule.end(),
+                                        [](const std::pair<const std::string, ScheduledTable>& scheduled) {
+                                            return scheduled.second.synced;
+                                        })) {
+                logger->Info("Full sync pass complete, continuing incrementally");
+                fullSync = false;
+            }
+        }
+        
+        logger->Info("Stop requested, shutting down sync daemon");
+        LogMetrics("Sync daemon");
+    
+    } catch (const std::exception& e) {
+        logger->Error("Sync daemon failed: " + std::string(e.what()));
+    }
+}
+
+bool DataSyncManager::Initialize() {
+    // Initialize database connector
+    dbConnector = std::make_unique<DatabaseConnector>(config, logger);
+    
+    if (!dbConnector->Connect()) {
+        logger->Error("Failed to connect to databases");
+        return false;
+    }
+    
+    // Initialize helpers
+    sqliteHelper = std::make_unique<SqliteHelper>(dbConnector->GetSqliteConnection(), logger);
+    odbcHelper = std::make_unique<OdbcHelper>(dbConnector->GetOdbcConnection(), dbConnector->GetOdbcEnvironment(), logger);
+    
+    throttle = std::make_shared<SourceThrottle>(config, logger);
+    if (throttle->Enabled()) {
+        odbcHelper->SetThrottle(throttle);
+    } else {
+        throttle.reset();
+    }
+    
+    // Initialize state tracking
+    syncState = std::make_shared<SyncState>(dbConnector->GetSqliteConnection(), logger);
+    syncHistory = std::make_shared<SyncHistory>(dbConnector->GetSqliteConnection(), logger);
+    
+    // Initialize hash database if enabled
+    if (config.hashDb.enableHashing) {
+        hashDb = std::make_shared<HashStorage>(config.hashDb.dbPath, logger, config.hashDb.columnGroupSize);
+        if (!hashDb->Initialize()) {
+            logger->Error("Failed to initialize hash database");
+            hashDb.reset();
+        } else {
+            logger->Info("Hash database initialized successfully");
+            
+            if (!hashPool) {
+                hashPool = std::make_shared<HashWorkerPool>(config.mirrorSettings.hashThreads);
+                logger->Info("Started hash worker pool with " + std::to_string(hashPool->GetThreadCount()) + " threads");
+            }
+        }
+    }
+    
+    // Create table syncer
+    tableSyncer = std::make_unique<TableSyncer>(
+        *sqliteHelper,
+        *odbcHelper,
+        syncState,
+        syncHistory,
+        hashDb,
+        hashPool,
+        logger,
+        config,
+        config.mirrorSettings.batchSize
+    );
+    
+    return true;
+}
+
+int DataSyncManager::SyncTrackedTable(const TableInfo& tableInfo, bool forceFull, double priority, bool& connectionUsable) {
+    SyncScheduler::Slot slot(scheduler.get(), priority);
+    metrics.slotWaitSeconds += slot.GetWaitSeconds();
+    
+    try {
+        int errorsBefore = logger->GetErrorCount();
+        if (throttle) {
+            throttle->BeginTable();
+        }
+        int rows = SyncTableWithRetry(tableInfo, forceFull, connectionUsable);
+        
+        metrics.tablesProcessed++;
+        metrics.rowsSynced += rows;
+        
+        // Counters were read before the sync, so writes made during it still show up next run
+        auto activity = tableActivity.find(tableInfo.tableName);
+        if (activity != tableActivity.end()) {
+            if (logger->GetErrorCount() == errorsBefore) {
+                syncState->SetTableActivity(tableInfo.tableName, activityEpoch, activity->second.creates,
+                                            activity->second.updates, activity->second.deletes);
+            } else {
+                syncState->SetTableActivity(tableInfo.tableName, "", 0, 0, 0);
+            }
+        }
+        
+        return rows;
+    } catch (const std::exception& e) {
+        logger->Error("Error syncing table " + tableInfo.tableName + ": " + e.what());
+        return 0;
+    }
+}
+
+void DataSyncManager::LogMetrics(const std::string& label) {
+    double duration = difftime(time(nullptr), metrics.startTime);
+    logger->Info(label + " completed in " + std::to_string(duration) + " seconds");
+    logger->Info("Processed " + std::to_string(metrics.tablesProcessed) + " tables");
+    logger->Info("Synced " + std::to_string(metrics.rowsSynced) + " rows");
+    if (metrics.reconnects > 0) {
+        logger->Info("Reconnected to OpenEdge " + std::to_string(metrics.reconnects) + " times");
+    }
+    if (metrics.slotWaitSeconds >= 1) {
+        logger->Info("Waited " + std::to_string(static_cast<int>(metrics.slotWaitSeconds)) + 
+                    " seconds for tables of other sources");
+    }
+    if (throttle && throttle->GetThrottledSeconds() > 0) {
+        logger->Info("Paused " + std::to_string(static_cast<int>(throttle->GetThrottledSeconds())) + 
+                    " seconds to limit load on OpenEdge");
+    }
+}
+
+void DataSyncManager::RebuildHashes() {
+    logger->Info("Rebuilding hash database from mirror " + config.sqliteDb.dbPath);
+    
+    metrics.startTime = time(nullptr);
+    
+    try {
+        // Only the mirror is opened; the OpenEdge source is never contacted
+        dbConnector = std::make_unique<DatabaseConnector>(config, logger);
+        
+        if (!dbConnector->ConnectSqlite()) {
+            logger->Error("Failed to connect to mirror database");
+            return;
+        }
+        
+        if (!config.hashDb.enableHashing) {
+            logger->Warning("hash_db.enable_hashing is off; rebuilt hashes are used once it is enabled");
+        }
+        
+        syncState = std::make_shared<SyncState>(dbConnector->GetSqliteConnection(), logger);
+        
+        hashDb = std::make_shared<HashStorage>(config.hashDb.dbPath, logger, config.hashDb.columnGroupSize);
+        if (!hashDb->Initialize()) {
+            logger->Error("Failed to initialize hash database");
+            return;
+        }
+        
+        std::vector<HashRebuilder::TableSpec> tables;
+        for (const auto& tableName : syncState->GetTablesWithKeys()) {
+            if (ignoredTables.find(tableName) != ignoredTables.end()) {
+                continue;
+            }
+            
+            HashRebuilder::TableSpec spec;
+            spec.tableName = tableName;
+            spec.keyColumn = syncState->GetLastSync(tableName).keyColumn;
+            spec.columns = GetHashedColumns(tableName, spec.keyColumn);
+            tables.push_back(spec);
+        }
+        
+        if (tables.empty()) {
+            logger->Error("No mirrored tables with a recorded key column; run a sync first");
+            return;
+        }
+        
+        HashRebuilder rebuilder(config.sqliteDb.dbPath, hashDb, logger,
+                                config.mirrorSettings.hashThreads, config.hashDb.rebuildRangeSize);
+        int rowsHashed = rebuilder.Rebuild(tables);
+        
+        double duration = difftime(time(nullptr), metrics.startTime);
+        logger->Info("Hash rebuild completed in " + std::to_string(duration) + " seconds");
+        logger->Info("Rebuilt " + std::to_string(rowsHashed) + " row hashes for " + 
+                    std::to_string(tables.size()) + " tables");
+    
+    } catch (const std::exception& e) {
+        logger->Error("Hash rebuild failed: " + std::string(e.what()));
+    }
+}
+
+std::vector<std::string> DataSyncManager::GetHashedColumns(const std::string& tableName, const std::string& keyColumn) {
+    auto settings = config.tables.find(tableName);
+    if (settings == config.tables.end()) {
+        return {};
+    }
+    
+    // The mirror stands in for the source catalog; the sync's own selection rule then
+    // yields the columns it hashes, in mirror order
+    TableInfo tableInfo;
+    tableInfo.tableName = tableName;
+    tableInfo.pkColumns = KeyCodec::SplitColumns(keyColumn);
+    
+    sqlite3* conn = dbConnector->GetSqliteConnection();
+    sqlite3_stmt* stmt = nullptr;
+    std::string pragmaSql = "PRAGMA table_info(" + tableName + ")";
+    if (sqlite3_prepare_v2(conn, pragmaSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return {};
+    }
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* colName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        tableInfo.columns.push_back(colName ? colName : "");
+        tableInfo.columnTypes.push_back(0);
+        if (tableInfo.columns.back() == "_oe_rowid") {
+            tableInfo.rowidColumn = tableInfo.columns.back();
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    ApplyColumnSelection(tableInfo, settings->second);
+    return tableInfo.columns;
+}
+
 void DataSyncManager::LoadIgnoreList() {
     std::string ignoreFile = config.mirrorSettings.ignoreFile;
     
@@ -151,12 +511,23 @@ void DataSyncManager::AddToIgnoreList(const std::vector<std::string>& tables) {
     }
 }
 
-std::vector<TableInfo> DataSyncManager::GetSourceTables() {
+std::vector<TableInfo> DataSyncManager::GetSourceTables(bool skipUnchanged) {
     std::vector<TableInfo> tables;
+    QueryPlanner planner(logger);
     
     try {
         // Get list of tables in the schema
         auto tableNames = odbcHelper->GetTableList("PUB");
+        auto changeTables = FindChangeTables(tableNames);
+        
+        // Change tables living next to their sources are read by the cdc strategy, not mirrored
+        std::set<std::string> changeTableNames;
+        for (const auto& changeTable : changeTables) {
+            std::string lowerName = changeTable.second;
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                          [](unsigned char c) { return std::tolower(c); });
+            changeTableNames.insert(lowerName);
+        }
         
         for (const auto& tableName : tableNames) {
             std::string lowerTableName = tableName;
@@ -168,38 +539,115 @@ std::vector<TableInfo> DataSyncManager::GetSourceTables() {
                 continue;
             }
             
+            if (changeTableNames.count(lowerTableName)) {
+                continue;
+            }
+            
+            // Decided before any metadata query so untouched tables cost nothing
+            if (skipUnchanged && IsTableUnchanged(lowerTableName)) {
+                metrics.tablesSkipped++;
+                continue;
+            }
+            
             TableInfo tableInfo;
             tableInfo.tableName = lowerTableName;
             
-            // Get primary key
-            tableInfo.pkColumn = odbcHelper->GetPrimaryKeyColumn("PUB", tableName);
+            auto configured = config.tables.find(lowerTableName);
+            const Config::TableSettings* settings = configured != config.tables.end() ? &configured->second : nullptr;
+            
+            // Get primary key columns
+            tableInfo.pkColumns = odbcHelper->GetPrimaryKeyColumns("PUB", tableName);
             
             // Transform to lowercase
-            std::transform(tableInfo.pkColumn.begin(), tableInfo.pkColumn.end(), tableInfo.pkColumn.begin(),
-                          [](unsigned char c) { return std::tolower(c); });
+            for (auto& pkColumn : tableInfo.pkColumns) {
+                std::transform(pkColumn.begin(), pkColumn.end(), pkColumn.begin(),
+                              [](unsigned char c) { return std::tolower(c); });
+            }
+            
+            if (!tableInfo.pkColumns.empty()) {
+                tableInfo.keyKind = "primary_key";
+            }
             
             // Get column information
+            std::vector<OdbcColumn> columns;
             std::string sql = "SELECT * FROM PUB." + lowerTableName + " WHERE 1=0";
             SQLHSTMT stmt = odbcHelper->ExecuteQuery(sql);
             
             if (stmt != SQL_NULL_HSTMT) {
-                auto columns = odbcHelper->GetColumns(stmt);
+                columns = odbcHelper->GetColumns(stmt);
                 
-                for (const auto& column : columns) {
-                    std::string colName = column.name;
-                    std::transform(colName.begin(), colName.end(), colName.begin(),
+                for (auto& column : columns) {
+                    std::transform(column.name.begin(), column.name.end(), column.name.begin(),
                                   [](unsigned char c) { return std::tolower(c); });
-                    tableInfo.columns.push_back(colName);
+                    tableInfo.columns.push_back(column.name);
+                    tableInfo.columnTypes.push_back(column.dataType);
                 }
                 
                 odbcHelper->FreeStatement(stmt);
             }
             
             if (!tableInfo.columns.empty()) {
+                auto indexes = odbcHelper->GetIndexes("PUB", tableName);
+                
+                if (settings && !settings->keyColumns.empty()) {
+                    bool found = std::all_of(settings->keyColumns.begin(), settings->keyColumns.end(),
+                                            [&tableInfo](const std::string& column) {
+                                                return std::find(tableInfo.columns.begin(), tableInfo.columns.end(), column) != tableInfo.columns.end();
+                                            });
+                    if (found) {
+                        tableInfo.pkColumns = settings->keyColumns;
+                        tableInfo.keyKind = "config";
+                    } else {
+                        logger->Warning("Configured key " + KeyCodec::JoinColumns(settings->keyColumns) + 
+                                       " not found in " + lowerTableName + ", ignoring it");
+                    }
+                }
+                
+                // Most tables declare no primary key but do have a unique index
+                if (tableInfo.pkColumns.empty()) {
+                    const OdbcIndex* uniqueKey = FindUniqueKey(indexes, columns);
+                    if (uniqueKey) {
+                        tableInfo.pkColumns = uniqueKey->columns;
+                        tableInfo.keyKind = "unique_index " + uniqueKey->name;
+                    }
+                }
+                
+                // Last resort is the record's ROWID. It changes on dump and load and can be reused
+                // after a delete, so it suits hash-based sync, which rereads every key, best.
+                if (tableInfo.pkColumns.empty() && config.mirrorSettings.rowidKeys) {
+                    AddRowidKey(tableInfo);
+                }
+                
+                // Anything still keyless is diffed as a multiset of row digests
+                if (tableInfo.pkColumns.empty() && config.hashDb.enableHashing) {
+                    tableInfo.digestColumn = "_oe_digest";
+                }
+                
+                // Change rows are matched to mirror rows by key, and they carry no ROWID
+                auto changeTable = changeTables.find(lowerTableName);
+                if (changeTable != changeTables.end()) {
+                    if (tableInfo.pkColumns.empty() || !tableInfo.rowidColumn.empty()) {
+                        logger->Warning("Table " + lowerTableName + " has a CDC change table but no key; not using it");
+                    } else if (settings && !settings->where.empty() && !config.mirrorSettings.cdcRefetchRows) {
+                        // Change rows cannot be tested against the filter; refetched rows can
+                        logger->Warning("Table " + lowerTableName + " has a source filter; not using its CDC change table without cdc_refetch_rows");
+                    } else {
+                        tableInfo.cdcTable = config.mirrorSettings.cdcSchema + ".\"" + changeTable->second + "\"";
+                        logger->Info("Table " + lowerTableName + " is captured in " + tableInfo.cdcTable);
+                    }
+                }
+                
+                if (settings) {
+                    ApplyColumnSelection(tableInfo, *settings);
+                    tableInfo.sourceFilter = settings->where;
+                }
+                
+                tableInfo.plan = planner.Plan(tableInfo, indexes, settings ? settings->timestampColumn : "");
                 tables.push_back(tableInfo);
                 logger->Info("Found table " + lowerTableName + " with " + 
-                            std::to_string(tableInfo.columns.size()) + " columns and PK: " + 
-                            (tableInfo.pkColumn.empty() ? "none" : tableInfo.pkColumn));
+                            std::to_string(tableInfo.columns.size()) + " columns and key: " + 
+                            (tableInfo.pkColumns.empty() ? "none" : 
+                             KeyCodec::JoinColumns(tableInfo.pkColumns) + " (" + tableInfo.keyKind + ")"));
             }
         }
     } catch (const std::exception& e) {
@@ -207,4 +655,383 @@ std::vector<TableInfo> DataSyncManager::GetSourceTables() {
     }
     
     return tables;
-}
\ No newline at end of file
+}
+
+std::map<std::string, std::string> DataSyncManager::FindChangeTables(const std::vector<std::string>& sourceTables) {
+    std::map<std::string, std::string> changeTables;
+    
+    if (!config.mirrorSettings.cdcEnabled) {
+        return changeTables;
+    }
+    
+    std::vector<std::string> candidates = config.mirrorSettings.cdcSchema == "PUB" ? 
+        sourceTables : odbcHelper->GetTableList(config.mirrorSettings.cdcSchema);
+    
+    std::string prefix = config.mirrorSettings.cdcTablePrefix;
+    std::transform(prefix.begin(), prefix.end(), prefix.begin(),
+                  [](unsigned char c) { return std::tolower(c); });
+    
+    for (const auto& name : candidates) {
+        std::string lowerName = name;
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                      [](unsigned char c) { return std::tolower(c); });
+        
+        if (lowerName.size() > prefix.size() && lowerName.compare(0, prefix.size(), prefix) == 0) {
+            changeTables[lowerName.substr(prefix.size())] = name;
+        }
+    }
+    
+    // Explicitly named change tables win over the naming convention
+    for (const auto& entry : config.tables) {
+        if (!entry.second.cdcTable.empty()) {
+            changeTables[entry.first] = entry.second.cdcTable;
+        }
+    }
+    
+    logger->Info("Found " + std::to_string(changeTables.size()) + " CDC change tables in schema " + 
+                config.mirrorSettings.cdcSchema);
+    return changeTables;
+}
+
+const OdbcIndex* DataSyncManager::FindUniqueKey(const std::vector<OdbcIndex>& indexes,
+                                               const std::vector<OdbcColumn>& columns) {
+    // OpenEdge unique indexes admit any number of unknown values, so only an index over
+    // mandatory columns identifies rows. Fewest columns wins, then the smallest total width.
+    const OdbcIndex* best = nullptr;
+    SQLULEN bestWidth = 0;
+    
+    for (const auto& index : indexes) {
+        if (!index.unique || index.columns.empty()) {
+            continue;
+        }
+        
+        SQLULEN width = 0;
+        bool usable = true;
+        for (const auto& indexColumn : index.columns) {
+            auto it = std::find_if(columns.begin(), columns.end(),
+                                  [&indexColumn](const OdbcColumn& column) { return column.name == indexColumn; });
+            if (it == columns.end() || it->nullable) {
+                usable = false;
+                break;
+            }
+            width += it->columnSize;
+        }
+        
+        if (!usable) {
+            continue;
+        }
+        
+        if (!best || index.columns.size() < best->columns.size() ||
+            (index.columns.size() == best->columns.size() && width < bestWidth)) {
+            best = &index;
+            bestWidth = width;
+        }
+    }
+    
+    return best;
+}
+
+void DataSyncManager::AddRowidKey(TableInfo& tableInfo) {
+    SQLHSTMT stmt = odbcHelper->ExecuteQuery("SELECT ROWID FROM PUB." + tableInfo.tableName + " WHERE 1=0");
+    if (stmt == SQL_NULL_HSTMT) {
+        logger->Warning("ROWID not available for " + tableInfo.tableName + ", leaving it without a key");
+        return;
+    }
+    
+    auto columns = odbcHelper->GetColumns(stmt);
+    odbcHelper->FreeStatement(stmt);
+    
+    if (columns.size() != 1) {
+        return;
+    }
+    
+    // Appended last so an existing mirror table gains it through ADD COLUMN in the same position
+    tableInfo.rowidColumn = "_oe_rowid";
+    tableInfo.columns.push_back(tableInfo.rowidColumn);
+    tableInfo.columnTypes.push_back(columns[0].dataType);
+    tableInfo.pkColumns.push_back(tableInfo.rowidColumn);
+    tableInfo.keyKind = "rowid";
+}
+
+void DataSyncManager::ApplyColumnSelection(TableInfo& tableInfo, const Config::TableSettings& settings) {
+    if (settings.columns.empty() && settings.excludeColumns.empty()) {
+        return;
+    }
+    
+    std::vector<std::string> columns;
+    std::vector<int> columnTypes;
+    tableInfo.excludedColumns.clear();
+    
+    for (size_t i = 0; i < tableInfo.columns.size(); ++i) {
+        const std::string& column = tableInfo.columns[i];
+        
+        // Key and incremental columns are always read, whatever the lists say
+        bool required = column == tableInfo.rowidColumn || column == settings.timestampColumn ||
+            std::find(tableInfo.pkColumns.begin(), tableInfo.pkColumns.end(), column) != tableInfo.pkColumns.end();
+        bool included = settings.columns.empty() ||
+            std::find(settings.columns.begin(), settings.columns.end(), column) != settings.columns.end();
+        bool excluded = std::find(settings.excludeColumns.begin(), settings.excludeColumns.end(), column) != settings.excludeColumns.end();
+        
+        if (required || (included && !excluded)) {
+            columns.push_back(column);
+            columnTypes.push_back(tableInfo.columnTypes[i]);
+        } else {
+            tableInfo.excludedColumns.push_back(column);
+        }
+    }
+    
+    logger->Info("Reading " + std::to_string(columns.size()) + " of " + std::to_string(tableInfo.columns.size()) + 
+                " columns of " + tableInfo.tableName);
+    tableInfo.columns = columns;
+    tableInfo.columnTypes = columnTypes;
+}
+
+int DataSyncManager::SyncTableWithRetry(const TableInfo& tableInfo, bool forceFull, bool& connectionUsable) {
+    int rows = 0;
+    
+    // An interrupted table is replayed; checkpoints make the replay continue after the last committed key
+    for (int attempt = 1; ; ++attempt) {
+        int failuresBefore = odbcHelper->RetryableFailures();
+        rows += tableSyncer->SyncTable(tableInfo, forceFull);
+        
+        if (odbcHelper->RetryableFailures() == failuresBefore) {
+            return rows;
+        }
+        
+        if (attempt > config.mirrorSettings.reconnectAttempts) {
+            logger->Error("Giving up on " + tableInfo.tableName + " after " + std::to_string(attempt) + " interrupted attempts");
+            connectionUsable = !odbcHelper->ConnectionLost();
+            return rows;
+        }
+        
+        logger->Warning(tableInfo.tableName + " was interrupted by " + 
+                       (odbcHelper->ConnectionLost() ? "a lost connection" : "a transient error") + 
+                       ", replaying it from its last checkpoint");
+        
+        if (!RecoverConnection(attempt)) {
+            connectionUsable = false;
+            return rows;
+        }
+    }
+}
+
+bool DataSyncManager::RecoverConnection(int attempt) {
+    if (!odbcHelper->ConnectionLost() && !odbcHelper->IsConnectionDead()) {
+        // Lock conflicts and timeouts only need time; the same backoff applies
+        std::this_thread::sleep_for(std::chrono::seconds(dbConnector->GetReconnectDelay(attempt)));
+        return true;
+    }
+    
+    if (!dbConnector->ReconnectOdbc()) {
+        return false;
+    }
+    
+    odbcHelper->SetConnection(dbConnector->GetOdbcConnection());
+    metrics.reconnects++;
+    logger->Info("Reconnected to OpenEdge");
+    return true;
+}
+
+void DataSyncManager::LoadTableActivity() {
+    tableActivity.clear();
+    activityEpoch.clear();
+    
+    if (!config.mirrorSettings.skipUnchangedTables || fullSync) {
+        return;
+    }
+    
+    // Counters are only comparable within one server lifetime, so both are required
+    activityEpoch = odbcHelper->GetDatabaseStartTime();
+    if (activityEpoch.empty()) {
+        logger->Warning("Could not read database start time from _DbStatus; syncing all tables");
+        return;
+    }
+    
+    tableActivity = odbcHelper->GetTableActivity();
+    if (tableActivity.empty()) {
+        logger->Warning("Could not read _TableStat counters; syncing all tables");
+        activityEpoch.clear();
+        return;
+    }
+    
+    logger->Info("Loaded write counters for " + std::to_string(tableActivity.size()) + 
+                " tables (database started " + activityEpoch + ")");
+}
+
+bool DataSyncManager::IsTableUnchanged(const std::string& tableName) {
+    if (activityEpoch.empty()) {
+        return false;
+    }
+    
+    // Tables outside the -tablerangesize window have no counters and are always synced
+    auto activity = tableActivity.find(tableName);
+    if (activity == tableActivity.end()) {
+        return false;
+    }
+    
+    auto lastSync = syncState->GetLastSync(tableName);
+    if (lastSync.lastSyncTime.empty() || lastSync.statEpoch.empty()) {
+        return false;
+    }
+    
+    // An interrupted sync has to finish even if nothing was written since
+    if (!lastSync.checkpointStrategy.empty()) {
+        return false;
+    }
+    
+    if (lastSync.statEpoch != activityEpoch) {
+        logger->Info("Database restarted since " + tableName + " was last synced, write counters reset");
+        return false;
+    }
+    
+    const TableActivity& current = activity->second;
+    if (current.creates < lastSync.statCreates || current.updates < lastSync.statUpdates ||
+        current.deletes < lastSync.statDeletes) {
+        logger->Warning("Write counters for " + tableName + " went backwards; syncing");
+        return false;
+    }
+    
+    if (current.creates == lastSync.statCreates && current.updates == lastSync.statUpdates &&
+        current.deletes == lastSync.statDeletes) {
+        logger->Info("Skipping " + tableName + ", no writes since " + lastSync.lastSyncTime);
+        return true;
+    }
+    
+    return false;
+}
+
+std::vector<DataSyncManager::PlannedTable> DataSyncManager::PlanTables(const std::vector<TableInfo>& tables) {
+    std::vector<PlannedTable> plan;
+    
+    for (const auto& tableInfo : tables) {
+        PlannedTable planned;
+        planned.tableInfo = tableInfo;
+        planned.score = 0;
+        planned.predictedSeconds = 0;
+        planned.deferredRuns = 0;
+        plan.push_back(planned);
+    }
+    
+    // Without a budget tables keep catalog order
+    if (timeBudgetSeconds <= 0) {
+        return plan;
+    }
+    
+    double knownSeconds = 0;
+    int knownTables = 0;
+    
+    for (auto& planned : plan) {
+        const std::string& tableName = planned.tableInfo.tableName;
+        auto lastSync = syncState->GetLastSync(tableName);
+        long long age = syncState->GetSecondsSinceSync(tableName);
+        
+        // Never-synced tables and unfinished reloads are as stale as it gets
+        planned.score = (age < 0 || !lastSync.checkpointStrategy.empty()) ? 
+            std::numeric_limits<double>::max() : static_cast<double>(age) * GetTableImportance(tableName);
+        planned.deferredRuns = lastSync.deferredRuns;
+        planned.predictedSeconds = syncHistory->PredictSeconds(tableName, PREDICTION_RUNS);
+        
+        if (planned.predictedSeconds >= 0) {
+            knownSeconds += planned.predictedSeconds;
+            knownTables++;
+        }
+    }
+    
+    // Tables without history are assumed to take as long as an average table that has some
+    double fallbackSeconds = knownTables > 0 ? knownSeconds / knownTables : 0;
+    for (auto& planned : plan) {
+        if (planned.predictedSeconds < 0) {
+            planned.predictedSeconds = fallbackSeconds;
+        }
+    }
+    
+    // Tables an earlier budget left out go first, longest waiting first
+    std::stable_sort(plan.begin(), plan.end(), [](const PlannedTable& a, const PlannedTable& b) {
+        if (a.deferredRuns != b.deferredRuns) {
+            return a.deferredRuns > b.deferredRuns;
+        }
+        return a.score > b.score;
+    });
+    
+    double plannedSeconds = 0;
+    for (const auto& planned : plan) {
+        plannedSeconds += planned.predictedSeconds;
+    }
+    logger->Info("Time budget " + std::to_string(timeBudgetSeconds) + "s, predicted " + 
+                std::to_string(plannedSeconds) + "s for " + std::to_string(plan.size()) + 
+                " tables; first up: " + plan.front().tableInfo.tableName);
+    
+    return plan;
+}
+
+double DataSyncManager::GetTableImportance(const std::string& tableName) {
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end()) {
+        return std::max(0.0, it->second.importance);
+    }
+    return 1.0;
+}
+
+void DataSyncManager::RefreshSchedule() {
+    auto tables = GetSourceTables(false);
+    if (tables.empty()) {
+        return;
+    }
+    
+    // Metadata is replaced, timing carries over; dropped tables leave the schedule
+    std::map<std::string, ScheduledTable> refreshed;
+    int newTables = 0;
+    for (const auto& tableInfo : tables) {
+        auto existing = schedule.find(tableInfo.tableName);
+        if (existing != schedule.end()) {
+            ScheduledTable entry = existing->second;
+            entry.tableInfo = tableInfo;
+            entry.intervalSeconds = GetTableInterval(tableInfo.tableName);
+            refreshed[tableInfo.tableName] = entry;
+            continue;
+        }
+        
+        ScheduledTable entry;
+        entry.tableInfo = tableInfo;
+        entry.intervalSeconds = GetTableInterval(tableInfo.tableName);
+        entry.backoff = 1;
+        entry.synced = false;
+        
+        // Freshness survives a daemon restart through sync_state
+        long long age = syncState->GetSecondsSinceSync(tableInfo.tableName);
+        entry.lastSynced = (age >= 0 && !fullSync) ? time(nullptr) - static_cast<time_t>(age) : 0;
+        
+        refreshed[tableInfo.tableName] = entry;
+        newTables++;
+    }
+    
+    logger->Info("Scheduling " + std::to_string(refreshed.size()) + " tables (" + std::to_string(newTables) + " new)");
+    schedule.swap(refreshed);
+}
+
+int DataSyncManager::GetTableInterval(const std::string& tableName) {
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end() && it->second.syncIntervalSeconds > 0) {
+        return it->second.syncIntervalSeconds;
+    }
+    return std::max(1, config.mirrorSettings.syncIntervalSeconds);
+}
+
+int DataSyncManager::GetEffectiveInterval(const ScheduledTable& entry) {
+    return entry.intervalSeconds * entry.backoff;
+}
+
+double DataSyncManager::GetStaleness(const ScheduledTable& entry, time_t now) {
+    // Never-synced tables outrank everything
+    if (entry.lastSynced == 0) {
+        return std::numeric_limits<double>::max();
+    }
+    return difftime(now, entry.lastSynced) / GetEffectiveInterval(entry);
+}
+
+void DataSyncManager::SleepUntil(time_t wakeTime) {
+    // Short naps so a stop signal is honoured promptly
+    while (!stopRequested && time(nullptr) < wakeTime) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
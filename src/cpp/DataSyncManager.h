@@ -4,28 +4,44 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
 #include <memory>
 #include <time.h>
 #include "Config.h"
 #include "Logger.h"
 #include "SyncState.h"
+#include "SyncHistory.h"
 #include "HashStorage.h"
+#include "HashWorkerPool.h"
 #include "DatabaseConnector.h"
 #include "SqliteHelper.h"
 #include "OdbcHelper.h"
 #include "TableSyncer.h"
+#include "SourceThrottle.h"
+#include "SyncScheduler.h"
 
 class DataSyncManager {
 public:
-    DataSyncManager(const std::string& configFile, bool fullSync = false, const std::vector<std::string>& ignoreTables = {});
+    // One source of a multi-source run passes the shared log, hash workers and scheduler;
+    // a single source creates its own log and workers and needs no scheduler
+    DataSyncManager(const Config& config, bool fullSync = false, const std::vector<std::string>& ignoreTables = {},
+                    int timeBudgetSeconds = 0, std::shared_ptr<Logger> logger = nullptr,
+                    std::shared_ptr<HashWorkerPool> hashPool = nullptr,
+                    std::shared_ptr<SyncScheduler> scheduler = nullptr);
     ~DataSyncManager();
     
     void RunSync();
+    // Long-running mode: each table is synced again once it is older than its interval.
+    // Stops on SIGINT/SIGTERM once InstallStopHandlers has run
+    void RunDaemon();
+    // Process-wide, so called once before any daemon starts
+    static void InstallStopHandlers();
+    void RebuildHashes();
 
 private:
-    std::string configFile;
     Config config;
     bool fullSync;
+    int timeBudgetSeconds;   // 0 = no budget; otherwise no table starts unless it is predicted to fit
     std::shared_ptr<Logger> logger;
     std::set<std::string> ignoredTables;
     
@@ -33,18 +49,78 @@ private:
     std::unique_ptr<SqliteHelper> sqliteHelper;
     std::unique_ptr<OdbcHelper> odbcHelper;
     std::shared_ptr<SyncState> syncState;
+    std::shared_ptr<SyncHistory> syncHistory;
     std::shared_ptr<HashStorage> hashDb;
+    std::shared_ptr<HashWorkerPool> hashPool;
     std::unique_ptr<TableSyncer> tableSyncer;
+    std::shared_ptr<SourceThrottle> throttle;
+    std::shared_ptr<SyncScheduler> scheduler;
+    
+    // _TableStat counters read at the start of the run, and the server start time they count from
+    std::map<std::string, TableActivity> tableActivity;
+    std::string activityEpoch;
+    
+    // A table's place in the daemon schedule
+    struct ScheduledTable {
+        TableInfo tableInfo;
+        int intervalSeconds;    // Target freshness
+        int backoff;            // Interval multiplier; doubles after each sync that changed nothing
+        time_t lastSynced;      // 0 = never
+        bool synced;            // Synced by this daemon; --full-sync only applies until then
+    };
+    std::map<std::string, ScheduledTable> schedule;
+    
+    // A table's place in a --time-budget run
+    struct PlannedTable {
+        TableInfo tableInfo;
+        double score;           // Seconds since last sync times importance
+        double predictedSeconds;
+        int deferredRuns;
+    };
+    
+    static constexpr int PREDICTION_RUNS = 5;
+    static constexpr int ACTIVITY_REFRESH_SECONDS = 5;
+    static constexpr int DAEMON_RECONNECT_SECONDS = 60;
     
     struct {
         int tablesProcessed;
+        int tablesSkipped;
+        int tablesDeferred;
         int rowsSynced;
+        int reconnects;
+        double slotWaitSeconds; // Waiting on tables of other sources
         time_t startTime;
     } metrics;
     
+    bool Initialize();
+    // priority orders the table against other sources' tables when a scheduler is shared
+    int SyncTrackedTable(const TableInfo& tableInfo, bool forceFull, double priority, bool& connectionUsable);
+    void LogMetrics(const std::string& label);
     void LoadIgnoreList();
     void AddToIgnoreList(const std::vector<std::string>& tables);
-    std::vector<TableInfo> GetSourceTables();
+    std::vector<TableInfo> GetSourceTables(bool skipUnchanged);
+    // Lowercase source table -> change table name, as the catalog spells it
+    std::map<std::string, std::string> FindChangeTables(const std::vector<std::string>& sourceTables);
+    const OdbcIndex* FindUniqueKey(const std::vector<OdbcIndex>& indexes, const std::vector<OdbcColumn>& columns);
+    void AddRowidKey(TableInfo& tableInfo);
+    void ApplyColumnSelection(TableInfo& tableInfo, const Config::TableSettings& settings);
+    // Mirror columns a hash-based sync of the table hashes; empty = all of them
+    std::vector<std::string> GetHashedColumns(const std::string& tableName, const std::string& keyColumn);
+    void LoadTableActivity();
+    int SyncTableWithRetry(const TableInfo& tableInfo, bool forceFull, bool& connectionUsable);
+    bool RecoverConnection(int attempt);
+    bool IsTableUnchanged(const std::string& tableName);
+    
+    // Time-budget planning
+    std::vector<PlannedTable> PlanTables(const std::vector<TableInfo>& tables);
+    double GetTableImportance(const std::string& tableName);
+    
+    // Daemon scheduling
+    void RefreshSchedule();
+    int GetTableInterval(const std::string& tableName);
+    int GetEffectiveInterval(const ScheduledTable& entry);
+    double GetStaleness(const ScheduledTable& entry, time_t now);
+    void SleepUntil(time_t wakeTime);
 };
 
 #endif
\ No newline at end of file
@@ -1,8 +1,20 @@
 #include "DatabaseConnector.h"
+#include "OdbcHelper.h"
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+constexpr int DatabaseConnector::MAX_RECONNECT_DELAY_SECONDS;
+constexpr int DatabaseConnector::SLOT_POLL_SECONDS;
 
 DatabaseConnector::DatabaseConnector(const Config& config, std::shared_ptr<Logger> logger)
-    : config(config), logger(logger), odbcEnv(SQL_NULL_HENV), odbcConn(SQL_NULL_HDBC), sqliteConn(nullptr) {
+    : config(config), logger(logger), odbcEnv(SQL_NULL_HENV), odbcConn(SQL_NULL_HDBC), sqliteConn(nullptr),
+      connectionSlotFd(-1) {
 }
 
 DatabaseConnector::~DatabaseConnector() {
@@ -24,111 +36,253 @@ bool DatabaseConnector::Connect() {
             return false;
         }
         
-        // Initialize ODBC connection
-        ret = SQLAllocHandle(SQL_HANDLE_DBC, odbcEnv, &odbcConn);
-        if (!SQL_SUCCEEDED(ret)) {
-            CheckOdbcError(odbcEnv, SQL_HANDLE_ENV, "allocating connection handle");
+        if (!AcquireConnectionSlot() || !ConnectOdbc()) {
             return false;
         }
-
-        // Try several different connection string formats
-        std::vector<std::string> connectionStrings;
         
-        // Standard Progress DataDirect OpenEdge connection string
+        // Initialize SQLite connection
+        if (!ConnectSqlite()) {
+            Disconnect();  // Changed from DisconnectDatabases()
+            return false;
+        }
+        
+        return true;
+    } catch (const std::exception& e) {
+        logger->Error(std::string("Error connecting to databases: ") + e.what());
+        Disconnect();  // Changed from DisconnectDatabases()
+        return false;
+    }
+}
+
+bool DatabaseConnector::ConnectOdbc() {
+    // Initialize ODBC connection
+    SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_DBC, odbcEnv, &odbcConn);
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckOdbcError(odbcEnv, SQL_HANDLE_ENV, "allocating connection handle");
+        return false;
+    }
+    
+    // Try several different connection string formats
+    std::vector<std::string> connectionStrings;
+    
+    // Standard Progress DataDirect OpenEdge connection string
+    connectionStrings.push_back(
+        "DRIVER={Progress OpenEdge Wire Protocol};"
+        "HOST=" + config.progressDb.host + ";"
+        "PORT=" + std::to_string(config.progressDb.port) + ";"
+        "DB=" + config.progressDb.dbName + ";"
+        "UID=" + config.progressDb.user + ";"
+        "PWD=" + config.progressDb.password + ";"
+    );
+    
+    // Alternative format sometimes used with Progress DataDirect
+    connectionStrings.push_back(
+        "DRIVER={Progress OpenEdge Wire Protocol};"
+        "HostName=" + config.progressDb.host + ";"
+        "PortNumber=" + std::to_string(config.progressDb.port) + ";"
+        "Database=" + config.progressDb.dbName + ";"
+        "User=" + config.progressDb.user + ";"
+        "Password=" + config.progressDb.password + ";"
+    );
+    
+    // Yet another alternative format that might work
+    connectionStrings.push_back(
+        "DRIVER={Progress OpenEdge Wire Protocol};"
+        "ServerName=" + config.progressDb.host + ";"
+        "PortNumber=" + std::to_string(config.progressDb.port) + ";"
+        "DatabaseName=" + config.progressDb.dbName + ";"
+        "LogonID=" + config.progressDb.user + ";"
+        "Password=" + config.progressDb.password + ";"
+    );
+    
+    // If DSN is provided, try that too
+    if (!config.progressDb.dsn.empty()) {
         connectionStrings.push_back(
-            "DRIVER={Progress OpenEdge Wire Protocol};"
-            "HOST=" + config.progressDb.host + ";"
-            "PORT=" + std::to_string(config.progressDb.port) + ";"
-            "DB=" + config.progressDb.dbName + ";"
+            "DSN=" + config.progressDb.dsn + ";"
             "UID=" + config.progressDb.user + ";"
             "PWD=" + config.progressDb.password + ";"
         );
-
-        // Alternative format sometimes used with Progress DataDirect
-        connectionStrings.push_back(
-            "DRIVER={Progress OpenEdge Wire Protocol};"
-            "HostName=" + config.progressDb.host + ";"
-            "PortNumber=" + std::to_string(config.progressDb.port) + ";"
-            "Database=" + config.progressDb.dbName + ";"
-            "User=" + config.progressDb.user + ";"
-            "Password=" + config.progressDb.password + ";"
-        );
-
-        // Yet another alternative format that might work
-        connectionStrings.push_back(
-            "DRIVER={Progress OpenEdge Wire Protocol};"
-            "ServerName=" + config.progressDb.host + ";"
-            "PortNumber=" + std::to_string(config.progressDb.port) + ";"
-            "DatabaseName=" + config.progressDb.dbName + ";"
-            "LogonID=" + config.progressDb.user + ";"
-            "Password=" + config.progressDb.password + ";"
-        );
-        
-        // If DSN is provided, try that too
-        if (!config.progressDb.dsn.empty()) {
-            connectionStrings.push_back(
-                "DSN=" + config.progressDb.dsn + ";"
-                "UID=" + config.progressDb.user + ";"
-                "PWD=" + config.progressDb.password + ";"
-            );
+    }
+    
+    // Prefetch depth is a DataDirect connection option rather than an ODBC attribute
+    if (config.progressDb.fetchArraySize > 0) {
+        for (auto& connStr : connectionStrings) {
+            connStr += "ArraySize=" + std::to_string(config.progressDb.fetchArraySize) + ";";
         }
+    }
+    
+    // Try each connection string until one works
+    bool connected = false;
+    std::string lastError;
+    
+    for (const auto& connStr : connectionStrings) {
+        logger->Info("Attempting connection with: " + connStr.substr(0, connStr.find("PWD=")) + "PWD=********;");
         
-        // Try each connection string until one works
-        bool connected = false;
-        std::string lastError;
+        SQLCHAR connStrOut[1024];
+        SQLSMALLINT connStrOutLen;
         
-        for (const auto& connStr : connectionStrings) {
-            logger->Info("Attempting connection with: " + connStr.substr(0, connStr.find("PWD=")) + "PWD=********;");
-            
-            SQLCHAR connStrOut[1024];
-            SQLSMALLINT connStrOutLen;
-            
-            ret = SQLDriverConnect(
-                odbcConn, 
-                NULL, 
-                (SQLCHAR*)connStr.c_str(), 
-                SQL_NTS, 
-                connStrOut, 
-                sizeof(connStrOut), 
-                &connStrOutLen, 
-                SQL_DRIVER_NOPROMPT
-            );
+        ret = SQLDriverConnect(
+            odbcConn, 
+            NULL, 
+            (SQLCHAR*)connStr.c_str(), 
+            SQL_NTS, 
+            connStrOut, 
+            sizeof(connStrOut), 
+            &connStrOutLen, 
+            SQL_DRIVER_NOPROMPT
+        );
+        
+        if (SQL_SUCCEEDED(ret)) {
+            connected = true;
+            logger->Info("Connected to OpenEdge database");
+            break;
+        } else {
+            std::string error = GetOdbcError(odbcConn, SQL_HANDLE_DBC);
+            lastError = error;
+            logger->Warning("Connection attempt failed: " + error);
+        }
+    }
+    
+    if (!connected) {
+        logger->Error("All connection attempts failed. Last error: " + lastError);
+        SQLFreeHandle(SQL_HANDLE_DBC, odbcConn);
+        odbcConn = SQL_NULL_HDBC;
+        return false;
+    }
+    
+    ApplySessionOptions();
+    return true;
+}
+
+void DatabaseConnector::ApplySessionOptions() {
+    // The mirror never writes to the source; a read-only session lets the driver skip write locking
+    SQLRETURN ret = SQLSetConnectAttr(odbcConn, SQL_ATTR_ACCESS_MODE, (SQLPOINTER)SQL_MODE_READ_ONLY, 0);
+    if (!SQL_SUCCEEDED(ret)) {
+        logger->Warning("Driver refused a read-only session: " + GetOdbcError(odbcConn, SQL_HANDLE_DBC));
+    }
+    
+    const std::string& level = config.progressDb.isolationLevel;
+    if (level.empty()) {
+        return;
+    }
+    
+    SQLUINTEGER isolation = 0;
+    if (!OdbcHelper::ParseIsolationLevel(level, isolation)) {
+        logger->Warning("Unknown isolation level '" + level + "', keeping the driver default");
+        return;
+    }
+    
+    ret = SQLSetConnectAttr(odbcConn, SQL_ATTR_TXN_ISOLATION, (SQLPOINTER)(SQLULEN)isolation, 0);
+    if (SQL_SUCCEEDED(ret)) {
+        logger->Info("Reading OpenEdge at isolation level " + level);
+    } else {
+        logger->Warning("Could not set isolation level " + level + ": " + GetOdbcError(odbcConn, SQL_HANDLE_DBC));
+    }
+}
+
+bool DatabaseConnector::AcquireConnectionSlot() {
+    int slots = config.progressDb.maxConnections;
+    if (slots <= 0 || connectionSlotFd >= 0) {
+        return true;
+    }
+    
+    // Slots are per server, so mirrors of different databases do not share a cap
+    std::string server = config.progressDb.host + "_" + std::to_string(config.progressDb.port) + "_" + 
+                         config.progressDb.dbName;
+    for (auto& c : server) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) {
+            c = '_';
+        }
+    }
+    std::string prefix = config.progressDb.connectionSlotDir + "/oe2sqlite-" + server + ".slot";
+    
+    bool waiting = false;
+    while (true) {
+        for (int slot = 0; slot < slots; ++slot) {
+            std::string path = prefix + std::to_string(slot);
+            int fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+            if (fd < 0) {
+                logger->Error("Cannot open connection slot " + path);
+                return false;
+            }
             
-            if (SQL_SUCCEEDED(ret)) {
-                connected = true;
-                logger->Info("Connected to OpenEdge database");
-                break;
-            } else {
-                std::string error = GetOdbcError(odbcConn, SQL_HANDLE_DBC);
-                lastError = error;
-                logger->Warning("Connection attempt failed: " + error);
+            // The lock is released by the kernel if the process dies, so slots never leak
+            if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+                connectionSlotFd = fd;
+                if (waiting) {
+                    logger->Info("Got OpenEdge connection slot " + std::to_string(slot + 1) + " of " + 
+                                std::to_string(slots));
+                }
+                return true;
             }
+            close(fd);
+        }
+        
+        if (!waiting) {
+            logger->Info("All " + std::to_string(slots) + " OpenEdge connection slots are in use, waiting for one");
+            waiting = true;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(SLOT_POLL_SECONDS));
+    }
+}
+
+void DatabaseConnector::ReleaseConnectionSlot() {
+    if (connectionSlotFd >= 0) {
+        flock(connectionSlotFd, LOCK_UN);
+        close(connectionSlotFd);
+        connectionSlotFd = -1;
+    }
+}
+
+bool DatabaseConnector::ReconnectOdbc() {
+    int attempts = std::max(1, config.mirrorSettings.reconnectAttempts);
+    
+    for (int attempt = 1; attempt <= attempts; ++attempt) {
+        int delaySeconds = GetReconnectDelay(attempt - 1);
+        if (delaySeconds > 0) {
+            logger->Info("Reconnecting to OpenEdge in " + std::to_string(delaySeconds) + "s (attempt " + 
+                        std::to_string(attempt) + " of " + std::to_string(attempts) + ")");
+            std::this_thread::sleep_for(std::chrono::seconds(delaySeconds));
         }
         
-        if (!connected) {
-            logger->Error("All connection attempts failed. Last error: " + lastError);
+        // The broken link is dropped with its handle so no driver state survives the failure
+        if (odbcConn != SQL_NULL_HDBC) {
+            SQLDisconnect(odbcConn);
             SQLFreeHandle(SQL_HANDLE_DBC, odbcConn);
             odbcConn = SQL_NULL_HDBC;
-            return false;
         }
         
-        // Initialize SQLite connection
-        int rc = sqlite3_open(config.sqliteDb.dbPath.c_str(), &sqliteConn);
-        if (rc != SQLITE_OK) {
-            logger->Error(std::string("Failed to connect to SQLite: ") + sqlite3_errmsg(sqliteConn));
-            Disconnect();  // Changed from DisconnectDatabases()
-            return false;
+        if (ConnectOdbc()) {
+            return true;
         }
-        
-        sqlite3_exec(sqliteConn, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
-        logger->Info("Connected to SQLite database at " + config.sqliteDb.dbPath);
-        
-        return true;
-    } catch (const std::exception& e) {
-        logger->Error(std::string("Error connecting to databases: ") + e.what());
-        Disconnect();  // Changed from DisconnectDatabases()
+    }
+    
+    logger->Error("Could not reconnect to OpenEdge after " + std::to_string(attempts) + " attempts");
+    return false;
+}
+
+int DatabaseConnector::GetReconnectDelay(int attempt) const {
+    int delaySeconds = std::max(0, config.mirrorSettings.reconnectDelaySeconds);
+    for (int i = 0; i < attempt && delaySeconds < MAX_RECONNECT_DELAY_SECONDS; ++i) {
+        delaySeconds *= 2;
+    }
+    
+    return std::min(delaySeconds, MAX_RECONNECT_DELAY_SECONDS);
+}
+
+bool DatabaseConnector::ConnectSqlite() {
+    int rc = sqlite3_open(config.sqliteDb.dbPath.c_str(), &sqliteConn);
+    if (rc != SQLITE_OK) {
+        logger->Error(std::string("Failed to connect to SQLite: ") + sqlite3_errmsg(sqliteConn));
+        sqlite3_close(sqliteConn);
+        sqliteConn = nullptr;
         return false;
     }
+    
+    sqlite3_exec(sqliteConn, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
+    logger->Info("Connected to SQLite database at " + config.sqliteDb.dbPath);
+    
+    return true;
 }
 
 std::string DatabaseConnector::GetOdbcError(SQLHANDLE handle, SQLSMALLINT handleType) {
@@ -156,6 +310,8 @@ void DatabaseConnector::Disconnect() {
         logger->Info("Closed OpenEdge connection");
     }
     
+    ReleaseConnectionSlot();
+    
     if (odbcEnv != SQL_NULL_HENV) {
         SQLFreeHandle(SQL_HANDLE_ENV, odbcEnv);
         odbcEnv = SQL_NULL_HENV;
@@ -15,7 +15,16 @@ public:
     ~DatabaseConnector();
 
     bool Connect();
+    bool ConnectSqlite();
     void Disconnect();
+    
+    // Replaces a dropped OpenEdge connection, backing off exponentially between attempts;
+    // the connection handle changes, so GetOdbcConnection must be read again
+    bool ReconnectOdbc();
+    
+    // Wait before retry `attempt` (0 for the first): reconnect_delay_seconds doubled per
+    // attempt and capped at MAX_RECONNECT_DELAY_SECONDS; a negative setting means no wait
+    int GetReconnectDelay(int attempt) const;
 
     // Getters for database handles
     SQLHDBC GetOdbcConnection() const { return odbcConn; }
@@ -33,6 +42,20 @@ private:
     // SQLite handle
     sqlite3* sqliteConn;
     
+    // Lock file held while connected when progress_db.max_connections caps connections
+    int connectionSlotFd;
+    
+    static constexpr int MAX_RECONNECT_DELAY_SECONDS = 60;
+    static constexpr int SLOT_POLL_SECONDS = 1;
+    
+    bool ConnectOdbc();
+    
+    // Read-only access and the configured isolation level, applied to every new connection
+    void ApplySessionOptions();
+    
+    // Waits for one of max_connections lock files for this server; a slot survives reconnects
+    bool AcquireConnectionSlot();
+    void ReleaseConnectionSlot();
     void CheckOdbcError(SQLHANDLE handle, SQLSMALLINT type, const std::string& action);
     std::string GetOdbcError(SQLHANDLE handle, SQLSMALLINT handleType);
 };
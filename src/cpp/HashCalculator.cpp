@@ -1,6 +1,7 @@
 #include "HashCalculator.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include <openssl/evp.h>
 
 std::string HashCalculator::CalculateRowHash(const std::vector<std::string>& rowData) {
@@ -13,6 +14,42 @@ std::string HashCalculator::CalculateRowHash(const std::vector<std::string>& row
     return Sha256(combinedData.str());
 }
 
+std::string HashCalculator::CalculateColumnHashes(const std::vector<std::string>& rowData, int groupSize) {
+    if (groupSize <= 0) {
+        return "";
+    }
+    
+    std::string result;
+    for (size_t start = 0; start < rowData.size(); start += groupSize) {
+        std::stringstream groupData;
+        size_t end = std::min(rowData.size(), start + static_cast<size_t>(groupSize));
+        
+        for (size_t i = start; i < end; ++i) {
+            groupData << rowData[i].length() << ":" << rowData[i] << "|";
+        }
+        
+        // 64 bits per group is plenty; the full row hash still decides whether a row changed
+        if (!result.empty()) {
+            result += ",";
+        }
+        result += Sha256(groupData.str()).substr(0, 16);
+    }
+    
+    return result;
+}
+
+std::vector<std::string> HashCalculator::SplitColumnHashes(const std::string& columnHashes) {
+    std::vector<std::string> digests;
+    std::stringstream ss(columnHashes);
+    std::string digest;
+    
+    while (std::getline(ss, digest, ',')) {
+        digests.push_back(digest);
+    }
+    
+    return digests;
+}
+
 std::string HashCalculator::Sha256(const std::string& input) {
     unsigned char hash[EVP_MAX_MD_SIZE];
     unsigned int hashLen;
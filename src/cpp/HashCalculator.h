@@ -8,6 +8,10 @@ class HashCalculator {
 public:
     static std::string CalculateRowHash(const std::vector<std::string>& rowData);
     
+    // One short digest per group of groupSize columns, comma separated
+    static std::string CalculateColumnHashes(const std::vector<std::string>& rowData, int groupSize);
+    static std::vector<std::string> SplitColumnHashes(const std::string& columnHashes);
+    
 private:
     static std::string Sha256(const std::string& input);
 };
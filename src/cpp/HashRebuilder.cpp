@@ -0,0 +1,264 @@
+#include "HashRebuilder.h"
+#include "HashCalculator.h"
+#include "KeyCodec.h"
+#include <thread>
+#include <algorithm>
+
+HashRebuilder::HashRebuilder(const std::string& mirrorPath,
+                             std::shared_ptr<HashStorage> hashDb,
+                             std::shared_ptr<Logger> logger,
+                             int threadCount,
+                             int rangeSize)
+    : mirrorPath(mirrorPath),
+      hashDb(hashDb),
+      logger(logger),
+      threadCount(threadCount),
+      rangeSize(rangeSize > 0 ? rangeSize : 50000),
+      nextUnit(0) {
+    if (this->threadCount <= 0) {
+        this->threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+int HashRebuilder::Rebuild(const std::vector<TableSpec>& tables) {
+    sqlite3* conn = nullptr;
+    if (sqlite3_open_v2(mirrorPath.c_str(), &conn, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        logger->Error("Failed to open mirror database " + mirrorPath + ": " + sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        return 0;
+    }
+
+    work.clear();
+    units.clear();
+    results.clear();
+    nextUnit = 0;
+
+    for (const auto& spec : tables) {
+        PlanTable(conn, spec);
+    }
+    sqlite3_close(conn);
+
+    if (units.empty()) {
+        logger->Warning("No mirror rows found to rebuild hashes from");
+        return 0;
+    }
+
+    // Stale hashes would hide rows deleted from the mirror, so each table starts empty
+    for (const auto& table : work) {
+        hashDb->DeleteTableHashes(table.tableName);
+    }
+
+    int workerCount = std::min(threadCount, static_cast<int>(units.size()));
+    logger->Info("Rebuilding hashes for " + std::to_string(work.size()) + " tables in " +
+                std::to_string(units.size()) + " ranges on " + std::to_string(workerCount) + " threads");
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&HashRebuilder::WorkerLoop, this);
+    }
+
+    // Workers only read the mirror; all writes to the hash store happen on this thread
+    int totalHashed = 0;
+    for (size_t received = 0; received < units.size(); ++received) {
+        UnitResult result;
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            resultCondition.wait(lock, [this]() { return !results.empty(); });
+            result = std::move(results.front());
+            results.pop_front();
+        }
+
+        TableWork& table = work[result.tableIndex];
+        if (!result.success ||
+            !hashDb->StoreHashes(table.tableName, result.pkValues, result.rowHashes, result.columnHashes)) {
+            table.failed = true;
+        } else {
+            table.rowsHashed += static_cast<int>(result.pkValues.size());
+            totalHashed += static_cast<int>(result.pkValues.size());
+        }
+
+        if (--table.pendingUnits == 0) {
+            if (table.failed) {
+                logger->Error("Hash rebuild of " + table.tableName + " incomplete; " +
+                             std::to_string(table.rowsHashed) + " rows hashed");
+            } else {
+                logger->Info("Rebuilt " + std::to_string(table.rowsHashed) + " hashes for " + table.tableName);
+            }
+        }
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return totalHashed;
+}
+
+bool HashRebuilder::PlanTable(sqlite3* conn, const TableSpec& spec) {
+    TableWork table;
+    table.tableName = spec.tableName;
+    table.pendingUnits = 0;
+    table.rowsHashed = 0;
+    table.failed = false;
+
+    // Mirror column order is the source column order the sync hashed with
+    std::string pragmaSql = "PRAGMA table_info(" + spec.tableName + ")";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(conn, pragmaSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        logger->Error("Error reading columns of " + spec.tableName + ": " + sqlite3_errmsg(conn));
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* colName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        table.columns.push_back(colName ? colName : "");
+    }
+    sqlite3_finalize(stmt);
+
+    if (table.columns.empty()) {
+        logger->Warning("Mirror table " + spec.tableName + " not found, skipping hash rebuild");
+        return false;
+    }
+
+    // Columns a table's column lists exclude are not part of its hashes
+    if (!spec.columns.empty()) {
+        table.columns = spec.columns;
+    }
+
+    for (const auto& keyColumn : KeyCodec::SplitColumns(spec.keyColumn)) {
+        auto it = std::find(table.columns.begin(), table.columns.end(), keyColumn);
+        if (it == table.columns.end()) {
+            logger->Warning("Key column " + keyColumn + " not found in mirror table " + spec.tableName +
+                           ", skipping hash rebuild");
+            return false;
+        }
+        table.keyIndexes.push_back(static_cast<int>(it - table.columns.begin()));
+    }
+
+    std::string boundsSql = "SELECT MIN(rowid), MAX(rowid) FROM " + spec.tableName;
+    if (sqlite3_prepare_v2(conn, boundsSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        logger->Error("Error reading rowid range of " + spec.tableName + ": " + sqlite3_errmsg(conn));
+        return false;
+    }
+
+    bool hasRows = false;
+    sqlite3_int64 minRowid = 0;
+    sqlite3_int64 maxRowid = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        hasRows = true;
+        minRowid = sqlite3_column_int64(stmt, 0);
+        maxRowid = sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+
+    size_t tableIndex = work.size();
+    work.push_back(table);
+
+    if (!hasRows) {
+        logger->Info("Mirror table " + spec.tableName + " is empty");
+        return true;
+    }
+
+    for (sqlite3_int64 first = minRowid; first <= maxRowid; first += rangeSize) {
+        WorkUnit unit;
+        unit.tableIndex = tableIndex;
+        unit.firstRowid = first;
+        unit.lastRowid = std::min(maxRowid, first + rangeSize - 1);
+        units.push_back(unit);
+        work[tableIndex].pendingUnits++;
+    }
+
+    return true;
+}
+
+void HashRebuilder::WorkerLoop() {
+    sqlite3* conn = nullptr;
+    bool connected = sqlite3_open_v2(mirrorPath.c_str(), &conn, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK;
+    if (!connected) {
+        logger->Error("Hash rebuild worker failed to open mirror database: " + std::string(sqlite3_errmsg(conn)));
+    }
+
+    while (true) {
+        WorkUnit unit;
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (nextUnit >= units.size()) {
+                break;
+            }
+            unit = units[nextUnit++];
+        }
+
+        UnitResult result;
+        if (connected) {
+            result = HashUnit(conn, unit);
+        } else {
+            result.tableIndex = unit.tableIndex;
+            result.success = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            results.push_back(std::move(result));
+        }
+        resultCondition.notify_one();
+    }
+
+    sqlite3_close(conn);
+}
+
+HashRebuilder::UnitResult HashRebuilder::HashUnit(sqlite3* conn, const WorkUnit& unit) {
+    const TableWork& table = work[unit.tableIndex];
+
+    UnitResult result;
+    result.tableIndex = unit.tableIndex;
+    result.success = false;
+
+    std::string selectSql = "SELECT ";
+    for (size_t i = 0; i < table.columns.size(); ++i) {
+        selectSql += "\"" + table.columns[i] + "\"";
+        if (i < table.columns.size() - 1) {
+            selectSql += ", ";
+        }
+    }
+    selectSql += " FROM " + table.tableName + " WHERE rowid BETWEEN ? AND ?";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(conn, selectSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        logger->Error("Error preparing mirror scan of " + table.tableName + ": " + sqlite3_errmsg(conn));
+        return result;
+    }
+
+    sqlite3_bind_int64(stmt, 1, unit.firstRowid);
+    sqlite3_bind_int64(stmt, 2, unit.lastRowid);
+
+    int columnGroupSize = hashDb->GetColumnGroupSize();
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        // NULL reads back as "", the same value GetColumnData yields for a NULL source column
+        std::vector<std::string> rowData;
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, static_cast<int>(i)));
+            rowData.push_back(value ? value : "");
+        }
+
+        std::string key = KeyCodec::Extract(rowData, table.keyIndexes);
+        if (key.empty()) {
+            continue;
+        }
+
+        result.pkValues.push_back(key);
+        result.rowHashes.push_back(HashCalculator::CalculateRowHash(rowData));
+        if (columnGroupSize > 0) {
+            result.columnHashes.push_back(HashCalculator::CalculateColumnHashes(rowData, columnGroupSize));
+        }
+    }
+
+    if (rc != SQLITE_DONE) {
+        logger->Error("Error scanning mirror table " + table.tableName + ": " + sqlite3_errmsg(conn));
+    } else {
+        result.success = true;
+    }
+
+    sqlite3_finalize(stmt);
+    return result;
+}
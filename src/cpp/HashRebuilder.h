@@ -0,0 +1,77 @@
+#ifndef HASH_REBUILDER_H
+#define HASH_REBUILDER_H
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "HashStorage.h"
+#include "Logger.h"
+
+// Recomputes row_hashes from the SQLite mirror alone, without touching the source.
+// Mirror values are the exact strings fetched from the source, so the hashes match
+// what a hash-based sync computes for unchanged rows.
+class HashRebuilder {
+public:
+    struct TableSpec {
+        std::string tableName;
+        std::string keyColumn;   // Comma-separated for a composite key, as in sync_state
+        std::vector<std::string> columns; // Columns the sync reads, in mirror order; empty = all
+    };
+
+    HashRebuilder(const std::string& mirrorPath,
+                  std::shared_ptr<HashStorage> hashDb,
+                  std::shared_ptr<Logger> logger,
+                  int threadCount,
+                  int rangeSize);
+
+    // Returns the number of row hashes written
+    int Rebuild(const std::vector<TableSpec>& tables);
+
+private:
+    struct TableWork {
+        std::string tableName;
+        std::vector<int> keyIndexes;
+        std::vector<std::string> columns;
+        int pendingUnits;
+        int rowsHashed;
+        bool failed;
+    };
+
+    // A rowid range of one mirror table, hashed by a single worker
+    struct WorkUnit {
+        size_t tableIndex;
+        sqlite3_int64 firstRowid;
+        sqlite3_int64 lastRowid;
+    };
+
+    struct UnitResult {
+        size_t tableIndex;
+        bool success;
+        std::vector<std::string> pkValues;
+        std::vector<std::string> rowHashes;
+        std::vector<std::string> columnHashes;
+    };
+
+    std::string mirrorPath;
+    std::shared_ptr<HashStorage> hashDb;
+    std::shared_ptr<Logger> logger;
+    int threadCount;
+    int rangeSize;
+
+    std::vector<TableWork> work;
+    std::vector<WorkUnit> units;
+    size_t nextUnit;
+    std::deque<UnitResult> results;
+    std::mutex resultMutex;
+    std::condition_variable resultCondition;
+
+    bool PlanTable(sqlite3* conn, const TableSpec& spec);
+    void WorkerLoop();
+    UnitResult HashUnit(sqlite3* conn, const WorkUnit& unit);
+};
+
+#endif // HASH_REBUILDER_H
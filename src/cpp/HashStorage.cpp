@@ -1,8 +1,9 @@
 #include "HashStorage.h"
 #include <stdexcept>
+#include <set>
 
-HashStorage::HashStorage(const std::string& dbPath, std::shared_ptr<Logger> logger)
-    : dbPath(dbPath), dbConn(nullptr), logger(logger) {
+HashStorage::HashStorage(const std::string& dbPath, std::shared_ptr<Logger> logger, int columnGroupSize)
+    : dbPath(dbPath), dbConn(nullptr), logger(logger), columnGroupSize(columnGroupSize) {
 }
 
 HashStorage::~HashStorage() {
@@ -29,7 +30,9 @@ bool HashStorage::EnsureHashTable() {
         "table_name TEXT NOT NULL,"
         "pk_value TEXT NOT NULL,"
         "row_hash TEXT NOT NULL,"
+        "column_hashes TEXT,"
         "last_updated TEXT NOT NULL,"
+        "bucket_id INTEGER,"
         "PRIMARY KEY (table_name, pk_value)"
         ")";
     
@@ -46,14 +49,74 @@ bool HashStorage::EnsureHashTable() {
         return false;
     }
     
+    // Hash files from older versions lack the later columns
+    std::set<std::string> existingColumns;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(dbConn, "PRAGMA table_info(row_hashes)", -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* colName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            if (colName) {
+                existingColumns.insert(colName);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    
+    if (!existingColumns.count("column_hashes") &&
+        !ExecuteSql("ALTER TABLE row_hashes ADD COLUMN column_hashes TEXT", "adding column_hashes to hash table")) {
+        return false;
+    }
+    
+    if (!existingColumns.count("bucket_id") &&
+        !ExecuteSql("ALTER TABLE row_hashes ADD COLUMN bucket_id INTEGER", "adding bucket_id to hash table")) {
+        return false;
+    }
+    
+    const char* fingerprintSql = 
+        "CREATE TABLE IF NOT EXISTS range_fingerprints ("
+        "table_name TEXT NOT NULL,"
+        "bucket_id INTEGER NOT NULL,"
+        "low_key TEXT,"
+        "high_key TEXT NOT NULL,"
+        "fingerprint TEXT NOT NULL,"
+        "PRIMARY KEY (table_name, bucket_id)"
+        ")";
+    
+    if (!ExecuteSql(fingerprintSql, "creating range fingerprint table") ||
+        !ExecuteSql("CREATE INDEX IF NOT EXISTS idx_row_hashes_bucket ON row_hashes (table_name, bucket_id)",
+                    "creating hash bucket index")) {
+        return false;
+    }
+    
     logger->Info("Ensured hash table exists");
     return true;
 }
 
-bool HashStorage::StoreHash(const std::string& tableName, const std::string& pkValue, const std::string& rowHash) {
+bool HashStorage::ExecuteSql(const char* sql, const std::string& action) {
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(dbConn, sql, nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::string error = "Error " + action + ": ";
+        if (errMsg) {
+            error += errMsg;
+            sqlite3_free(errMsg);
+        }
+        logger->Error(error);
+        return false;
+    }
+    
+    return true;
+}
+
+bool HashStorage::StoreHash(const std::string& tableName, const std::string& pkValue, const std::string& rowHash,
+                            const std::string& columnHashes) {
     const char* insertSql = 
-        "INSERT OR REPLACE INTO row_hashes (table_name, pk_value, row_hash, last_updated) "
-        "VALUES (?, ?, ?, datetime('now'))";
+        "INSERT INTO row_hashes (table_name, pk_value, row_hash, column_hashes, last_updated) "
+        "VALUES (?, ?, ?, ?, datetime('now')) "
+        "ON CONFLICT(table_name, pk_value) DO UPDATE SET "
+        "row_hash = excluded.row_hash, column_hashes = excluded.column_hashes, "
+        "last_updated = excluded.last_updated";
     
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(dbConn, insertSql, -1, &stmt, nullptr);
@@ -66,6 +129,11 @@ bool HashStorage::StoreHash(const std::string& tableName, const std::string& pkV
     sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, pkValue.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, rowHash.c_str(), -1, SQLITE_STATIC);
+    if (columnHashes.empty()) {
+        sqlite3_bind_null(stmt, 4);
+    } else {
+        sqlite3_bind_text(stmt, 4, columnHashes.c_str(), -1, SQLITE_STATIC);
+    }
     
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
@@ -78,6 +146,59 @@ bool HashStorage::StoreHash(const std::string& tableName, const std::string& pkV
     return true;
 }
 
+bool HashStorage::StoreHashes(const std::string& tableName,
+                              const std::vector<std::string>& pkValues,
+                              const std::vector<std::string>& rowHashes,
+                              const std::vector<std::string>& columnHashes) {
+    if (pkValues.size() != rowHashes.size() || 
+        (!columnHashes.empty() && columnHashes.size() != pkValues.size())) {
+        logger->Error("Mismatch between primary key and hash array sizes");
+        return false;
+    }
+    
+    const char* insertSql = 
+        "INSERT INTO row_hashes (table_name, pk_value, row_hash, column_hashes, last_updated) "
+        "VALUES (?, ?, ?, ?, datetime('now')) "
+        "ON CONFLICT(table_name, pk_value) DO UPDATE SET "
+        "row_hash = excluded.row_hash, column_hashes = excluded.column_hashes, "
+        "last_updated = excluded.last_updated";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, insertSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing hash insert statement: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    sqlite3_exec(dbConn, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+    
+    bool success = true;
+    for (size_t i = 0; i < pkValues.size(); ++i) {
+        sqlite3_reset(stmt);
+        sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, pkValues[i].c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, rowHashes[i].c_str(), -1, SQLITE_STATIC);
+        
+        if (columnHashes.empty() || columnHashes[i].empty()) {
+            sqlite3_bind_null(stmt, 4);
+        } else {
+            sqlite3_bind_text(stmt, 4, columnHashes[i].c_str(), -1, SQLITE_STATIC);
+        }
+        
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            logger->Error("Error storing hash: " + std::string(sqlite3_errmsg(dbConn)));
+            success = false;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    sqlite3_exec(dbConn, success ? "COMMIT" : "ROLLBACK", nullptr, nullptr, nullptr);
+    
+    return success;
+}
+
 std::string HashStorage::GetHash(const std::string& tableName, const std::string& pkValue) {
     const char* selectSql = 
         "SELECT row_hash FROM row_hashes WHERE table_name = ? AND pk_value = ?";
@@ -105,6 +226,34 @@ std::string HashStorage::GetHash(const std::string& tableName, const std::string
     return hash;
 }
 
+HashStorage::StoredHash HashStorage::GetStoredHash(const std::string& tableName, const std::string& pkValue) {
+    StoredHash stored;
+    
+    const char* selectSql = 
+        "SELECT row_hash, column_hashes FROM row_hashes WHERE table_name = ? AND pk_value = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing hash select statement: " + std::string(sqlite3_errmsg(dbConn)));
+        return stored;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, pkValue.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* hashText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        const char* columnText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        stored.rowHash = hashText ? hashText : "";
+        stored.columnHashes = columnText ? columnText : "";
+    }
+    
+    sqlite3_finalize(stmt);
+    return stored;
+}
+
 bool HashStorage::DeleteHash(const std::string& tableName, const std::string& pkValue) {
     const char* deleteSql = 
         "DELETE FROM row_hashes WHERE table_name = ? AND pk_value = ?";
@@ -152,13 +301,278 @@ bool HashStorage::DeleteTableHashes(const std::string& tableName) {
         return false;
     }
     
+    // Fingerprints describe the deleted bucket membership, so they go too
+    rc = sqlite3_prepare_v2(dbConn, "DELETE FROM range_fingerprints WHERE table_name = ?", -1, &stmt, nullptr);
+    if (rc == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+        rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    
+    if (rc != SQLITE_DONE) {
+        logger->Error("Error deleting range fingerprints: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    return true;
+}
+
+bool HashStorage::DeleteHashes(const std::string& tableName, const std::vector<std::string>& pkValues) {
+    if (pkValues.empty()) {
+        return true;
+    }
+    
+    const char* deleteSql = 
+        "DELETE FROM row_hashes WHERE table_name = ? AND pk_value = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, deleteSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing hash delete statement: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    sqlite3_exec(dbConn, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+    
+    bool success = true;
+    for (const auto& pkValue : pkValues) {
+        sqlite3_reset(stmt);
+        sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, pkValue.c_str(), -1, SQLITE_STATIC);
+        
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            logger->Error("Error deleting hash: " + std::string(sqlite3_errmsg(dbConn)));
+            success = false;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    sqlite3_exec(dbConn, success ? "COMMIT" : "ROLLBACK", nullptr, nullptr, nullptr);
+    
+    return success;
+}
+
+bool HashStorage::BeginSeenTracking() {
+    const char* resetSql = 
+        "CREATE TEMP TABLE IF NOT EXISTS seen_keys (pk_value TEXT PRIMARY KEY);"
+        "DELETE FROM seen_keys;";
+    
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(dbConn, resetSql, nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::string error = "Error resetting seen keys: ";
+        if (errMsg) {
+            error += errMsg;
+            sqlite3_free(errMsg);
+        }
+        logger->Error(error);
+        return false;
+    }
+    
     return true;
 }
 
+bool HashStorage::MarkSeen(const std::vector<std::string>& pkValues) {
+    const char* insertSql = "INSERT OR IGNORE INTO seen_keys (pk_value) VALUES (?)";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, insertSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing seen key insert statement: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    sqlite3_exec(dbConn, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+    
+    bool success = true;
+    for (const auto& pkValue : pkValues) {
+        sqlite3_reset(stmt);
+        sqlite3_bind_text(stmt, 1, pkValue.c_str(), -1, SQLITE_STATIC);
+        
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            logger->Error("Error marking key as seen: " + std::string(sqlite3_errmsg(dbConn)));
+            success = false;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    sqlite3_exec(dbConn, success ? "COMMIT" : "ROLLBACK", nullptr, nullptr, nullptr);
+    
+    return success;
+}
+
+std::vector<std::string> HashStorage::GetUnseenKeys(const std::string& tableName) {
+    std::vector<std::string> unseenKeys;
+    
+    const char* selectSql = 
+        "SELECT pk_value FROM row_hashes "
+        "WHERE table_name = ? "
+        "AND NOT EXISTS (SELECT 1 FROM seen_keys s WHERE s.pk_value = row_hashes.pk_value)";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing unseen key query: " + std::string(sqlite3_errmsg(dbConn)));
+        return unseenKeys;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* pkText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (pkText) {
+            unseenKeys.push_back(pkText);
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    return unseenKeys;
+}
+
+std::vector<HashStorage::RangeFingerprint> HashStorage::GetFingerprints(const std::string& tableName) {
+    std::vector<RangeFingerprint> ranges;
+    
+    const char* selectSql = 
+        "SELECT bucket_id, low_key, high_key, fingerprint FROM range_fingerprints "
+        "WHERE table_name = ? ORDER BY bucket_id";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing fingerprint query: " + std::string(sqlite3_errmsg(dbConn)));
+        return ranges;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        RangeFingerprint range;
+        range.bucketId = sqlite3_column_int(stmt, 0);
+        range.hasLowKey = sqlite3_column_type(stmt, 1) != SQLITE_NULL;
+        
+        const char* lowKey = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        const char* highKey = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        const char* fingerprint = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        range.lowKey = lowKey ? lowKey : "";
+        range.highKey = highKey ? highKey : "";
+        range.fingerprint = fingerprint ? fingerprint : "";
+        ranges.push_back(range);
+    }
+    
+    sqlite3_finalize(stmt);
+    return ranges;
+}
+
+bool HashStorage::StoreFingerprint(const std::string& tableName, const RangeFingerprint& range) {
+    const char* insertSql = 
+        "INSERT OR REPLACE INTO range_fingerprints "
+        "(table_name, bucket_id, low_key, high_key, fingerprint) VALUES (?, ?, ?, ?, ?)";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, insertSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing fingerprint insert statement: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, range.bucketId);
+    if (range.hasLowKey) {
+        sqlite3_bind_text(stmt, 3, range.lowKey.c_str(), -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 3);
+    }
+    sqlite3_bind_text(stmt, 4, range.highKey.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, range.fingerprint.c_str(), -1, SQLITE_STATIC);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        logger->Error("Error storing fingerprint: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    return true;
+}
+
+std::vector<std::string> HashStorage::GetBucketKeys(const std::string& tableName, int bucketId) {
+    std::vector<std::string> keys;
+    
+    const char* selectSql = "SELECT pk_value FROM row_hashes WHERE table_name = ? AND bucket_id IS ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing bucket key query: " + std::string(sqlite3_errmsg(dbConn)));
+        return keys;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    if (bucketId > 0) {
+        sqlite3_bind_int(stmt, 2, bucketId);
+    } else {
+        sqlite3_bind_null(stmt, 2);
+    }
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* pkText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (pkText) {
+            keys.push_back(pkText);
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    return keys;
+}
+
+bool HashStorage::AssignBucket(const std::string& tableName, int bucketId, const std::vector<std::string>& pkValues) {
+    const char* updateSql = "UPDATE row_hashes SET bucket_id = ? WHERE table_name = ? AND pk_value = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(dbConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing bucket update statement: " + std::string(sqlite3_errmsg(dbConn)));
+        return false;
+    }
+    
+    sqlite3_exec(dbConn, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+    
+    bool success = true;
+    for (const auto& pkValue : pkValues) {
+        sqlite3_reset(stmt);
+        sqlite3_bind_int(stmt, 1, bucketId);
+        sqlite3_bind_text(stmt, 2, tableName.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, pkValue.c_str(), -1, SQLITE_STATIC);
+        
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            logger->Error("Error assigning hash bucket: " + std::string(sqlite3_errmsg(dbConn)));
+            success = false;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    sqlite3_exec(dbConn, success ? "COMMIT" : "ROLLBACK", nullptr, nullptr, nullptr);
+    
+    return success;
+}
+
 std::vector<std::string> HashStorage::GetChangedRows(
     const std::string& tableName, 
     const std::vector<std::string>& pkValues,
-    const std::vector<std::string>& rowHashes) {
+    const std::vector<std::string>& rowHashes,
+    std::vector<std::string>* newRows) {
     
     std::vector<std::string> changedRows;
     
@@ -172,6 +586,9 @@ std::vector<std::string> HashStorage::GetChangedRows(
         
         if (storedHash.empty() || storedHash != rowHashes[i]) {
             changedRows.push_back(pkValues[i]);
+            if (newRows && storedHash.empty()) {
+                newRows->push_back(pkValues[i]);
+            }
         }
     }
     
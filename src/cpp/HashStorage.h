@@ -9,25 +9,66 @@
 
 class HashStorage {
 public:
-    HashStorage(const std::string& dbPath, std::shared_ptr<Logger> logger);
+    struct StoredHash {
+        std::string rowHash;
+        std::string columnHashes;
+    };
+    
+    // Server-side aggregate over the key range (lowKey, highKey] from the last run
+    struct RangeFingerprint {
+        int bucketId;
+        bool hasLowKey;         // false for the first bucket, which is open below
+        std::string lowKey;
+        std::string highKey;
+        std::string fingerprint;
+    };
+    
+    HashStorage(const std::string& dbPath, std::shared_ptr<Logger> logger, int columnGroupSize = 0);
     ~HashStorage();
 
     bool Initialize();
-    bool StoreHash(const std::string& tableName, const std::string& pkValue, const std::string& rowHash);
+    bool StoreHash(const std::string& tableName, const std::string& pkValue, const std::string& rowHash,
+                   const std::string& columnHashes = "");
+    bool StoreHashes(const std::string& tableName,
+                     const std::vector<std::string>& pkValues,
+                     const std::vector<std::string>& rowHashes,
+                     const std::vector<std::string>& columnHashes);
     std::string GetHash(const std::string& tableName, const std::string& pkValue);
+    StoredHash GetStoredHash(const std::string& tableName, const std::string& pkValue);
+    
+    // Columns per digest in column_hashes; 0 stores the row hash only
+    int GetColumnGroupSize() const { return columnGroupSize; }
     bool DeleteHash(const std::string& tableName, const std::string& pkValue);
     bool DeleteTableHashes(const std::string& tableName);
+    bool DeleteHashes(const std::string& tableName, const std::vector<std::string>& pkValues);
+    
+    // Delete detection: keys seen in the current source scan are recorded in a
+    // temp table; stored keys never marked seen are gone from the source
+    bool BeginSeenTracking();
+    bool MarkSeen(const std::vector<std::string>& pkValues);
+    std::vector<std::string> GetUnseenKeys(const std::string& tableName);
+    
+    // Range fingerprints; bucket membership of stored hashes lets deletes be found per bucket
+    std::vector<RangeFingerprint> GetFingerprints(const std::string& tableName);
+    bool StoreFingerprint(const std::string& tableName, const RangeFingerprint& range);
+    // bucketId 0 selects hashes not yet assigned to any range
+    std::vector<std::string> GetBucketKeys(const std::string& tableName, int bucketId);
+    bool AssignBucket(const std::string& tableName, int bucketId, const std::vector<std::string>& pkValues);
+    // Keys with no stored hash are also collected in newRows when it is given
     std::vector<std::string> GetChangedRows(
         const std::string& tableName, 
         const std::vector<std::string>& pkValues,
-        const std::vector<std::string>& rowHashes);
+        const std::vector<std::string>& rowHashes,
+        std::vector<std::string>* newRows = nullptr);
 
 private:
     std::string dbPath;
     sqlite3* dbConn;
     std::shared_ptr<Logger> logger;
+    int columnGroupSize;
 
     bool EnsureHashTable();
+    bool ExecuteSql(const char* sql, const std::string& action);
 };
 
 #endif
\ No newline at end of file
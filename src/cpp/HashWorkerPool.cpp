@@ -0,0 +1,80 @@
+#include "HashWorkerPool.h"
+#include "HashCalculator.h"
+#include <chrono>
+#include <memory>
+
+HashWorkerPool::HashWorkerPool(int threadCount) : stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) {
+            threadCount = 1;
+        }
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&HashWorkerPool::WorkerLoop, this);
+    }
+}
+
+HashWorkerPool::~HashWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+std::future<HashBatchResult> HashWorkerPool::Submit(std::shared_ptr<const std::vector<std::vector<std::string>>> rows,
+                                                    int columnGroupSize) {
+    // std::function needs a copyable target, so the task lives behind a shared_ptr
+    auto task = std::make_shared<std::packaged_task<HashBatchResult()>>(
+        [batch = std::move(rows), columnGroupSize]() {
+            auto start = std::chrono::steady_clock::now();
+
+            HashBatchResult result;
+            result.rowHashes.reserve(batch->size());
+            for (const auto& row : *batch) {
+                result.rowHashes.push_back(HashCalculator::CalculateRowHash(row));
+                if (columnGroupSize > 0) {
+                    result.columnHashes.push_back(HashCalculator::CalculateColumnHashes(row, columnGroupSize));
+                }
+            }
+
+            result.hashSeconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            return result;
+        });
+
+    std::future<HashBatchResult> future = task->get_future();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.emplace([task]() { (*task)(); });
+    }
+    queueCondition.notify_one();
+
+    return future;
+}
+
+void HashWorkerPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (stopping && tasks.empty()) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
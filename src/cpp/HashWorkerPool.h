@@ -0,0 +1,48 @@
+#ifndef HASH_WORKER_POOL_H
+#define HASH_WORKER_POOL_H
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+
+// Result of hashing one batch; rowHashes[i] belongs to rows[i] of the submitted batch
+struct HashBatchResult {
+    std::vector<std::string> rowHashes;
+    std::vector<std::string> columnHashes;  // empty unless column hashing is enabled
+    double hashSeconds;
+};
+
+class HashWorkerPool {
+public:
+    // threadCount <= 0 uses one worker per hardware thread
+    explicit HashWorkerPool(int threadCount = 0);
+    ~HashWorkerPool();
+
+    HashWorkerPool(const HashWorkerPool&) = delete;
+    HashWorkerPool& operator=(const HashWorkerPool&) = delete;
+
+    // Queue a whole batch for hashing; futures complete independently, so callers
+    // wait on them in submission order to keep results aligned with the fetch order.
+    // The rows are shared with the caller, who must not modify them until the future is ready
+    std::future<HashBatchResult> Submit(std::shared_ptr<const std::vector<std::vector<std::string>>> rows,
+                                        int columnGroupSize = 0);
+
+    int GetThreadCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping;
+
+    void WorkerLoop();
+};
+
+#endif // HASH_WORKER_POOL_H
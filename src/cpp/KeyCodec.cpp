@@ -0,0 +1,67 @@
+#include "KeyCodec.h"
+#include <nlohmann/json.hpp>
+
+std::string KeyCodec::Encode(const std::vector<std::string>& values) {
+    if (values.size() == 1) {
+        return values[0];
+    }
+
+    return nlohmann::json(values).dump();
+}
+
+std::vector<std::string> KeyCodec::Decode(const std::string& key, size_t columnCount) {
+    if (columnCount == 1) {
+        return {key};
+    }
+
+    try {
+        auto values = nlohmann::json::parse(key).get<std::vector<std::string>>();
+        if (values.size() == columnCount) {
+            return values;
+        }
+    } catch (const std::exception&) {
+        // Not a composite key; callers treat an empty result as unusable
+    }
+
+    return {};
+}
+
+std::string KeyCodec::Extract(const std::vector<std::string>& rowData, const std::vector<int>& keyIndexes) {
+    std::vector<std::string> values;
+    bool allEmpty = true;
+
+    for (int index : keyIndexes) {
+        values.push_back(rowData[index]);
+        allEmpty = allEmpty && rowData[index].empty();
+    }
+
+    return (values.empty() || allEmpty) ? "" : Encode(values);
+}
+
+std::string KeyCodec::JoinColumns(const std::vector<std::string>& columns) {
+    std::string joined;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        joined += columns[i];
+        if (i < columns.size() - 1) {
+            joined += ",";
+        }
+    }
+
+    return joined;
+}
+
+std::vector<std::string> KeyCodec::SplitColumns(const std::string& columns) {
+    std::vector<std::string> result;
+    size_t start = 0;
+
+    while (start <= columns.size() && !columns.empty()) {
+        size_t end = columns.find(',', start);
+        if (end == std::string::npos) {
+            end = columns.size();
+        }
+        result.push_back(columns.substr(start, end - start));
+        start = end + 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,25 @@
+#ifndef KEY_CODEC_H
+#define KEY_CODEC_H
+
+#include <string>
+#include <vector>
+
+// Packs the values of a primary key into the single string stored in the hash store and
+// sync_state. A one-column key is its own value, so existing hashes and watermarks stay
+// valid; a composite key is a JSON array of its column values in key order.
+class KeyCodec {
+public:
+    static std::string Encode(const std::vector<std::string>& values);
+
+    // Empty when the key does not hold columnCount values
+    static std::vector<std::string> Decode(const std::string& key, size_t columnCount);
+
+    // Key of a fetched row; empty when every key column is empty
+    static std::string Extract(const std::vector<std::string>& rowData, const std::vector<int>& keyIndexes);
+
+    // Key column lists as recorded in sync_state.key_column
+    static std::string JoinColumns(const std::vector<std::string>& columns);
+    static std::vector<std::string> SplitColumns(const std::string& columns);
+};
+
+#endif // KEY_CODEC_H
@@ -1,12 +1,16 @@
 #include "Logger.h"
 
-Logger::Logger(const std::string& logFile) {
+Logger::Logger(const std::string& logFile) : errorCount(0) {
     fileStream.open(logFile, std::ios::out | std::ios::app);
     if (!fileStream.is_open()) {
         std::cerr << "Failed to open log file: " << logFile << std::endl;
     }
 }
 
+Logger::Logger(std::shared_ptr<Logger> parent, const std::string& tag)
+    : parent(parent), tag(tag), errorCount(0) {
+}
+
 Logger::~Logger() {
     if (fileStream.is_open()) {
         fileStream.close();
@@ -14,6 +18,15 @@ Logger::~Logger() {
 }
 
 void Logger::Log(LogLevel level, const std::string& message) {
+    if (parent) {
+        if (level == LogLevel::ERROR) {
+            std::lock_guard<std::mutex> lock(logMutex);
+            errorCount++;
+        }
+        parent->Log(level, "[" + tag + "] " + message);
+        return;
+    }
+    
     std::string timestamp = GetCurrentTime();
     std::string levelStr = LevelToString(level);
     
@@ -21,6 +34,10 @@ void Logger::Log(LogLevel level, const std::string& message) {
     
     std::lock_guard<std::mutex> lock(logMutex);
     
+    if (level == LogLevel::ERROR) {
+        errorCount++;
+    }
+    
     // Write to file
     if (fileStream.is_open()) {
         fileStream << formattedMessage << std::endl;
@@ -43,9 +60,16 @@ void Logger::Error(const std::string& message) {
     Log(LogLevel::ERROR, message);
 }
 
+int Logger::GetErrorCount() {
+    std::lock_guard<std::mutex> lock(logMutex);
+    return errorCount;
+}
+
 std::string Logger::GetCurrentTime() {
+    // Source threads log concurrently; localtime's shared buffer is not safe for that
     auto now = std::time(nullptr);
-    auto tm = *std::localtime(&now);
+    std::tm tm;
+    localtime_r(&now, &tm);
     
     std::ostringstream oss;
     oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
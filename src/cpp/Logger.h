@@ -5,6 +5,7 @@
 #include <fstream>
 #include <iostream>
 #include <mutex>
+#include <memory>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
@@ -18,16 +19,24 @@ enum class LogLevel {
 class Logger {
 public:
     Logger(const std::string& logFile);
+    // Writes through parent with every message tagged; errors are counted per tag
+    Logger(std::shared_ptr<Logger> parent, const std::string& tag);
     ~Logger();
 
     void Log(LogLevel level, const std::string& message);
     void Info(const std::string& message);
     void Warning(const std::string& message);
     void Error(const std::string& message);
+    
+    // Errors logged so far; callers compare before and after a unit of work
+    int GetErrorCount();
 
 private:
     std::ofstream fileStream;
+    std::shared_ptr<Logger> parent;
+    std::string tag;
     std::mutex logMutex;
+    int errorCount;
     std::string GetCurrentTime();
     std::string LevelToString(LogLevel level);
 };
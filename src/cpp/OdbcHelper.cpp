@@ -1,20 +1,42 @@
 #include "OdbcHelper.h"
+#include "SourceThrottle.h"
 #include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cctype>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <set>
+
+// Catalog numbers come back as text; false when the text is not a whole int
+static bool ParseCatalogInt(const std::string& text, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    
+    value = static_cast<int>(parsed);
+    return true;
+}
 
 OdbcHelper::OdbcHelper(SQLHDBC connection, SQLHENV environment, std::shared_ptr<Logger> logger)
-    : connection(connection), environment(environment), logger(logger) {
+    : connection(connection), environment(environment), logger(logger), lastFetchFailed(false),
+      lastErrorClass(OdbcErrorClass::None), retryableFailures(0), connectionLost(false),
+      maxStatementLength(0), maxStatementLengthKnown(false), isolationLevel(""), initialIsolation(0) {
+    fetchStats = {0, 0, 0.0};
 }
 
 SQLHSTMT OdbcHelper::ExecuteQuery(const std::string& sql) {
-    SQLHSTMT stmt = SQL_NULL_HSTMT;
-    SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, connection, &stmt);
-    
-    if (!SQL_SUCCEEDED(ret)) {
-        CheckError(connection, SQL_HANDLE_DBC, "allocating statement handle");
+    SQLHSTMT stmt = AllocateStatement();
+    if (stmt == SQL_NULL_HSTMT) {
         return SQL_NULL_HSTMT;
     }
     
-    ret = SQLExecDirect(stmt, (SQLCHAR*)sql.c_str(), SQL_NTS);
+    SQLRETURN ret = SQLExecDirect(stmt, (SQLCHAR*)sql.c_str(), SQL_NTS);
     
     if (!SQL_SUCCEEDED(ret)) {
         CheckError(stmt, SQL_HANDLE_STMT, "executing query");
@@ -25,7 +47,7 @@ SQLHSTMT OdbcHelper::ExecuteQuery(const std::string& sql) {
     return stmt;
 }
 
-SQLHSTMT OdbcHelper::PrepareStatement(const std::string& sql) {
+SQLHSTMT OdbcHelper::AllocateStatement() {
     SQLHSTMT stmt = SQL_NULL_HSTMT;
     SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, connection, &stmt);
     
@@ -34,7 +56,21 @@ SQLHSTMT OdbcHelper::PrepareStatement(const std::string& sql) {
         return SQL_NULL_HSTMT;
     }
     
-    ret = SQLPrepare(stmt, (SQLCHAR*)sql.c_str(), SQL_NTS);
+    // Every scan is read once front to back, so ask for the cheapest cursor the driver has:
+    // no scrolling, no update locks. Drivers that already default to this may refuse the call
+    SQLSetStmtAttr(stmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER)SQL_CURSOR_FORWARD_ONLY, 0);
+    SQLSetStmtAttr(stmt, SQL_ATTR_CONCURRENCY, (SQLPOINTER)SQL_CONCUR_READ_ONLY, 0);
+    
+    return stmt;
+}
+
+SQLHSTMT OdbcHelper::PrepareStatement(const std::string& sql) {
+    SQLHSTMT stmt = AllocateStatement();
+    if (stmt == SQL_NULL_HSTMT) {
+        return SQL_NULL_HSTMT;
+    }
+    
+    SQLRETURN ret = SQLPrepare(stmt, (SQLCHAR*)sql.c_str(), SQL_NTS);
     
     if (!SQL_SUCCEEDED(ret)) {
         CheckError(stmt, SQL_HANDLE_STMT, "preparing statement");
@@ -67,6 +103,149 @@ bool OdbcHelper::BindParameter(SQLHSTMT statement, int paramIndex, const std::st
     return true;
 }
 
+bool OdbcHelper::BindTimestampParameter(SQLHSTMT statement, int paramIndex, SQL_TIMESTAMP_STRUCT& value) {
+    // OpenEdge DATETIME carries milliseconds: 23 characters, 3 fractional digits
+    SQLRETURN ret = SQLBindParameter(
+        statement,
+        paramIndex,
+        SQL_PARAM_INPUT,
+        SQL_C_TYPE_TIMESTAMP,
+        SQL_TYPE_TIMESTAMP,
+        23,
+        3,
+        &value,
+        sizeof(value),
+        nullptr
+    );
+    
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckError(statement, SQL_HANDLE_STMT, "binding timestamp parameter");
+        return false;
+    }
+    
+    return true;
+}
+
+bool OdbcHelper::BindDateParameter(SQLHSTMT statement, int paramIndex, SQL_DATE_STRUCT& value) {
+    SQLRETURN ret = SQLBindParameter(
+        statement,
+        paramIndex,
+        SQL_PARAM_INPUT,
+        SQL_C_TYPE_DATE,
+        SQL_TYPE_DATE,
+        10,
+        0,
+        &value,
+        sizeof(value),
+        nullptr
+    );
+    
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckError(statement, SQL_HANDLE_STMT, "binding date parameter");
+        return false;
+    }
+    
+    return true;
+}
+
+bool OdbcHelper::BindTypedParameter(SQLHSTMT statement, int paramIndex, int sqlType, const std::string& value, OdbcParam& storage) {
+    storage.text = value;
+    
+    switch (sqlType) {
+        case SQL_INTEGER:
+        case SQL_SMALLINT:
+        case SQL_TINYINT:
+        case SQL_BIGINT: {
+            try {
+                size_t used = 0;
+                storage.integer = std::stoll(value, &used);
+                if (used != value.size()) {
+                    break;
+                }
+            } catch (const std::exception&) {
+                break;
+            }
+            
+            SQLRETURN ret = SQLBindParameter(statement, paramIndex, SQL_PARAM_INPUT, SQL_C_SBIGINT,
+                                             static_cast<SQLSMALLINT>(sqlType), 0, 0, &storage.integer, 0, nullptr);
+            if (!SQL_SUCCEEDED(ret)) {
+                CheckError(statement, SQL_HANDLE_STMT, "binding integer parameter");
+                return false;
+            }
+            return true;
+        }
+        
+        case SQL_DECIMAL:
+        case SQL_NUMERIC:
+        case SQL_FLOAT:
+        case SQL_REAL:
+        case SQL_DOUBLE: {
+            // Sent as characters but typed numeric, so the column is not converted for comparison
+            size_t dot = storage.text.find('.');
+            SQLSMALLINT scale = (dot == std::string::npos) ? 0 : static_cast<SQLSMALLINT>(storage.text.size() - dot - 1);
+            SQLRETURN ret = SQLBindParameter(statement, paramIndex, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_DECIMAL,
+                                             storage.text.length(), scale, (SQLPOINTER)storage.text.c_str(),
+                                             storage.text.length(), nullptr);
+            if (!SQL_SUCCEEDED(ret)) {
+                CheckError(statement, SQL_HANDLE_STMT, "binding decimal parameter");
+                return false;
+            }
+            return true;
+        }
+        
+        case SQL_TYPE_TIMESTAMP:
+        case SQL_TIMESTAMP:
+            if (ParseTimestamp(value, storage.timestamp)) {
+                return BindTimestampParameter(statement, paramIndex, storage.timestamp);
+            }
+            break;
+        
+        case SQL_TYPE_DATE:
+        case SQL_DATE:
+            if (ParseTimestamp(value, storage.timestamp)) {
+                storage.date.year = storage.timestamp.year;
+                storage.date.month = storage.timestamp.month;
+                storage.date.day = storage.timestamp.day;
+                return BindDateParameter(statement, paramIndex, storage.date);
+            }
+            break;
+        
+        default:
+            break;
+    }
+    
+    return BindParameter(statement, paramIndex, storage.text);
+}
+
+bool OdbcHelper::ParseTimestamp(const std::string& text, SQL_TIMESTAMP_STRUCT& timestamp) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int fields = std::sscanf(text.c_str(), "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+    
+    if (fields != 3 && fields != 6) {
+        return false;
+    }
+    
+    timestamp.year = static_cast<SQLSMALLINT>(year);
+    timestamp.month = static_cast<SQLUSMALLINT>(month);
+    timestamp.day = static_cast<SQLUSMALLINT>(day);
+    timestamp.hour = static_cast<SQLUSMALLINT>(hour);
+    timestamp.minute = static_cast<SQLUSMALLINT>(minute);
+    timestamp.second = static_cast<SQLUSMALLINT>(second);
+    timestamp.fraction = 0;
+    
+    // Fraction is in nanoseconds; OpenEdge keeps milliseconds, so digits past 9 are dropped
+    size_t dot = text.find('.', 10);
+    if (fields == 6 && dot != std::string::npos) {
+        SQLUINTEGER scale = 100000000;
+        for (size_t i = dot + 1; i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])) && scale > 0; ++i) {
+            timestamp.fraction += (text[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
 bool OdbcHelper::ExecutePreparedStatement(SQLHSTMT statement) {
     SQLRETURN ret = SQLExecute(statement);
     
@@ -78,18 +257,103 @@ bool OdbcHelper::ExecutePreparedStatement(SQLHSTMT statement) {
     return true;
 }
 
+bool OdbcHelper::CloseCursor(SQLHSTMT statement) {
+    SQLRETURN ret = SQLFreeStmt(statement, SQL_CLOSE);
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckError(statement, SQL_HANDLE_STMT, "closing cursor");
+        return false;
+    }
+    return true;
+}
+
+bool OdbcHelper::SetIsolationLevel(const std::string& level) {
+    if (level == isolationLevel) {
+        return true;
+    }
+    
+    // The level the connection started with is what an empty level returns to
+    if (isolationLevel.empty()) {
+        SQLRETURN ret = SQLGetConnectAttr(connection, SQL_ATTR_TXN_ISOLATION, &initialIsolation, 0, nullptr);
+        if (!SQL_SUCCEEDED(ret)) {
+            initialIsolation = 0;
+        }
+    }
+    
+    SQLUINTEGER isolation = initialIsolation;
+    if (!level.empty() && !ParseIsolationLevel(level, isolation)) {
+        logger->Warning("Unknown isolation level '" + level + "', keeping the current one");
+        return false;
+    }
+    
+    if (isolation == 0) {
+        logger->Warning("Cannot restore the connection's original isolation level, keeping " + isolationLevel);
+        return false;
+    }
+    
+    SQLRETURN ret = SQLSetConnectAttr(connection, SQL_ATTR_TXN_ISOLATION, (SQLPOINTER)(SQLULEN)isolation, 0);
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckError(connection, SQL_HANDLE_DBC, "setting isolation level " + level);
+        return false;
+    }
+    
+    isolationLevel = level;
+    return true;
+}
+
+bool OdbcHelper::ParseIsolationLevel(const std::string& level, SQLUINTEGER& isolation) {
+    std::string name = level;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    
+    // NOLOCK is the name OpenEdge users know dirty reads by
+    if (name == "read_uncommitted" || name == "nolock") {
+        isolation = SQL_TXN_READ_UNCOMMITTED;
+    } else if (name == "read_committed") {
+        isolation = SQL_TXN_READ_COMMITTED;
+    } else if (name == "repeatable_read") {
+        isolation = SQL_TXN_REPEATABLE_READ;
+    } else if (name == "serializable") {
+        isolation = SQL_TXN_SERIALIZABLE;
+    } else {
+        return false;
+    }
+    
+    return true;
+}
+
+SQLUINTEGER OdbcHelper::GetMaxStatementLength() {
+    if (maxStatementLengthKnown) {
+        return maxStatementLength;
+    }
+    
+    // Asked once per connection; a driver that cannot say is treated as unlimited
+    SQLUINTEGER value = 0;
+    SQLRETURN ret = SQLGetInfo(connection, SQL_MAX_STATEMENT_LEN, &value, sizeof(value), nullptr);
+    maxStatementLength = SQL_SUCCEEDED(ret) ? value : 0;
+    maxStatementLengthKnown = true;
+    return maxStatementLength;
+}
+
 bool OdbcHelper::FetchRow(SQLHSTMT statement) {
+    auto start = std::chrono::steady_clock::now();
     SQLRETURN ret = SQLFetch(statement);
+    fetchStats.fetchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    lastFetchFailed = false;
     
     if (ret == SQL_NO_DATA) {
         return false;
     }
     
     if (!SQL_SUCCEEDED(ret)) {
+        // Distinguishes a broken scan from end of data for callers that act on "not seen"
+        lastFetchFailed = true;
         CheckError(statement, SQL_HANDLE_STMT, "fetching row");
         return false;
     }
     
+    fetchStats.rows++;
+    if (throttle) {
+        throttle->Pace(fetchStats);
+    }
     return true;
 }
 
@@ -115,7 +379,11 @@ std::string OdbcHelper::GetColumnData(SQLHSTMT statement, int columnIndex) {
         return "";
     }
     
-    return std::string(dataBuffer, (indicator > sizeof(dataBuffer)) ? sizeof(dataBuffer) : indicator);
+    // SQL_NO_TOTAL and values longer than the buffer leave it full up to the terminator
+    size_t maxLength = sizeof(dataBuffer) - 1;
+    size_t length = indicator < 0 ? maxLength : std::min(static_cast<size_t>(indicator), maxLength);
+    fetchStats.bytes += length;
+    return std::string(dataBuffer, length);
 }
 
 std::vector<OdbcColumn> OdbcHelper::GetColumns(SQLHSTMT statement) {
@@ -149,6 +417,7 @@ std::vector<OdbcColumn> OdbcHelper::GetColumns(SQLHSTMT statement) {
             column.name = std::string(reinterpret_cast<char*>(columnName), columnNameLength);
             column.dataType = dataType;
             column.columnSize = columnSize;
+            column.nullable = nullable != SQL_NO_NULLS;
             columns.push_back(column);
         }
     }
@@ -201,13 +470,14 @@ std::vector<std::string> OdbcHelper::GetTableList(const std::string& schema) {
     return tables;
 }
 
-std::string OdbcHelper::GetPrimaryKeyColumn(const std::string& schema, const std::string& tableName) {
+std::vector<std::string> OdbcHelper::GetPrimaryKeyColumns(const std::string& schema, const std::string& tableName) {
+    std::vector<std::string> pkColumns;
     SQLHSTMT stmt = SQL_NULL_HSTMT;
     SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, connection, &stmt);
     
     if (!SQL_SUCCEEDED(ret)) {
         CheckError(connection, SQL_HANDLE_DBC, "allocating statement handle");
-        return "";
+        return pkColumns;
     }
     
     // Get primary key information
@@ -221,25 +491,154 @@ std::string OdbcHelper::GetPrimaryKeyColumn(const std::string& schema, const std
     if (!SQL_SUCCEEDED(ret)) {
         CheckError(stmt, SQL_HANDLE_STMT, "getting primary key info");
         SQLFreeHandle(SQL_HANDLE_STMT, stmt);
-        return "";
+        return pkColumns;
     }
     
-    std::string pkColumn;
+    // One row per key column: COLUMN_NAME(4), KEY_SEQ(5)
+    std::map<int, std::string> keyParts;
+    bool keyReadable = true;
+    while (FetchRow(stmt)) {
+        std::string columnName = GetColumnData(stmt, 4);
+        std::string keySeq = GetColumnData(stmt, 5);
+        if (columnName.empty()) {
+            continue;
+        }
+        
+        int position = static_cast<int>(keyParts.size()) + 1;
+        if (!keySeq.empty() && !ParseCatalogInt(keySeq, position)) {
+            logger->Warning("Unreadable KEY_SEQ '" + keySeq + "' for " + tableName + "." + columnName);
+            keyReadable = false;
+            continue;
+        }
+        keyParts[position] = columnName;
+    }
     
-    // The column name is in the 4th column
-    if (SQL_SUCCEEDED(SQLFetch(stmt))) {
-        SQLLEN indicator;
-        char columnNameBuffer[256];
+    SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+    
+    // A key missing one of its columns would match rows it does not identify
+    if (!keyReadable) {
+        logger->Warning("Ignoring the primary key of " + tableName + " because part of it could not be read");
+        return pkColumns;
+    }
+    
+    for (const auto& part : keyParts) {
+        pkColumns.push_back(part.second);
+    }
+    
+    return pkColumns;
+}
+
+std::vector<OdbcIndex> OdbcHelper::GetIndexes(const std::string& schema, const std::string& tableName) {
+    std::vector<OdbcIndex> indexes;
+    
+    SQLHSTMT stmt = SQL_NULL_HSTMT;
+    SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, connection, &stmt);
+    
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckError(connection, SQL_HANDLE_DBC, "allocating statement handle");
+        return indexes;
+    }
+    
+    ret = SQLStatistics(
+        stmt,
+        nullptr, 0,                             // Catalog
+        (SQLCHAR*)schema.c_str(), SQL_NTS,      // Schema
+        (SQLCHAR*)tableName.c_str(), SQL_NTS,   // Table
+        SQL_INDEX_ALL,
+        SQL_QUICK
+    );
+    
+    if (!SQL_SUCCEEDED(ret)) {
+        CheckError(stmt, SQL_HANDLE_STMT, "getting index info");
+        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        return indexes;
+    }
+    
+    // One row per index column: NON_UNIQUE(4), INDEX_NAME(6), TYPE(7), ORDINAL_POSITION(8), COLUMN_NAME(9)
+    std::set<std::string> unreadableIndexes;
+    while (FetchRow(stmt)) {
+        std::string type = GetColumnData(stmt, 7);
+        std::string indexName = GetColumnData(stmt, 6);
+        int typeValue = 0;
+        if (!type.empty() && !ParseCatalogInt(type, typeValue)) {
+            logger->Warning("Unreadable index type '" + type + "' for " + tableName + 
+                           (indexName.empty() ? std::string() : " index " + indexName));
+            unreadableIndexes.insert(indexName);
+            continue;
+        }
+        if (type.empty() || typeValue == SQL_TABLE_STAT) {
+            continue;
+        }
         
-        SQLGetData(stmt, 4, SQL_C_CHAR, columnNameBuffer, sizeof(columnNameBuffer), &indicator);
+        std::string columnName = GetColumnData(stmt, 9);
+        std::transform(columnName.begin(), columnName.end(), columnName.begin(),
+                      [](unsigned char c) { return std::tolower(c); });
         
-        if (indicator != SQL_NULL_DATA) {
-            pkColumn = std::string(columnNameBuffer, indicator);
+        if (indexes.empty() || indexes.back().name != indexName) {
+            OdbcIndex index;
+            index.name = indexName;
+            index.unique = GetColumnData(stmt, 4) == "0";
+            indexes.push_back(index);
         }
+        indexes.back().columns.push_back(columnName);
     }
     
     SQLFreeHandle(SQL_HANDLE_STMT, stmt);
-    return pkColumn;
+    
+    // An index missing one of its columns could pass for a unique key it is not
+    indexes.erase(std::remove_if(indexes.begin(), indexes.end(), [&](const OdbcIndex& index) {
+        return unreadableIndexes.count(index.name) > 0;
+    }), indexes.end());
+    return indexes;
+}
+
+std::map<std::string, TableActivity> OdbcHelper::GetTableActivity() {
+    std::map<std::string, TableActivity> activity;
+    
+    // Only tables inside the server's -tablerangesize window have a _TableStat row
+    std::string sql = 
+        "SELECT f.\"_File-Name\", t.\"_TableStat-create\", t.\"_TableStat-update\", t.\"_TableStat-delete\" "
+        "FROM PUB.\"_TableStat\" t, PUB.\"_File\" f "
+        "WHERE t.\"_TableStat-id\" = f.\"_File-Number\"";
+    
+    SQLHSTMT stmt = ExecuteQuery(sql);
+    if (stmt == SQL_NULL_HSTMT) {
+        return activity;
+    }
+    
+    while (FetchRow(stmt)) {
+        std::string tableName = GetColumnData(stmt, 1);
+        std::transform(tableName.begin(), tableName.end(), tableName.begin(),
+                      [](unsigned char c) { return std::tolower(c); });
+        
+        try {
+            TableActivity counters;
+            counters.creates = std::stoll(GetColumnData(stmt, 2));
+            counters.updates = std::stoll(GetColumnData(stmt, 3));
+            counters.deletes = std::stoll(GetColumnData(stmt, 4));
+            activity[tableName] = counters;
+        } catch (const std::exception&) {
+            logger->Warning("Unreadable _TableStat counters for " + tableName);
+        }
+    }
+    
+    FreeStatement(stmt);
+    return activity;
+}
+
+std::string OdbcHelper::GetDatabaseStartTime() {
+    SQLHSTMT stmt = ExecuteQuery("SELECT \"_DbStatus-starttime\" FROM PUB.\"_DbStatus\"");
+    if (stmt == SQL_NULL_HSTMT) {
+        return "";
+    }
+    
+    std::string startTime;
+    if (FetchRow(stmt)) {
+        startTime = GetColumnData(stmt, 1);
+    }
+    
+    FreeStatement(stmt);
+    return startTime;
 }
 
 std::vector<std::vector<std::string>> OdbcHelper::FetchBatch(SQLHSTMT statement, int batchSize) {
@@ -297,7 +696,61 @@ std::string OdbcHelper::GetLastError(SQLHANDLE handle, SQLSMALLINT handleType) {
     return "Unknown error";
 }
 
+OdbcErrorClass OdbcHelper::ClassifySqlState(const std::string& sqlState) {
+    // 08xxx is the connection exception class; HYT01 is the driver's connection timeout
+    if (sqlState.compare(0, 2, "08") == 0 || sqlState == "HYT01") {
+        return OdbcErrorClass::Connection;
+    }
+    
+    // Serialization failure, deadlock and query timeout (S1T00 is the ODBC 2 form)
+    if (sqlState == "40001" || sqlState == "40P01" || sqlState == "HYT00" || sqlState == "S1T00") {
+        return OdbcErrorClass::Transient;
+    }
+    
+    return OdbcErrorClass::Statement;
+}
+
+bool OdbcHelper::IsConnectionDead() {
+    SQLUINTEGER dead = 0;
+    SQLRETURN ret = SQLGetConnectAttr(connection, SQL_ATTR_CONNECTION_DEAD, &dead, 0, nullptr);
+    
+    // Drivers without the attribute are taken to be alive; failed calls still classify the error
+    return SQL_SUCCEEDED(ret) && dead == SQL_CD_TRUE;
+}
+
+void OdbcHelper::SetConnection(SQLHDBC connection) {
+    this->connection = connection;
+    connectionLost = false;
+    maxStatementLengthKnown = false;
+    isolationLevel = "";
+    lastErrorClass = OdbcErrorClass::None;
+}
+
 void OdbcHelper::CheckError(SQLHANDLE handle, SQLSMALLINT handleType, const std::string& action) {
     std::string error = GetLastError(handle, handleType);
     logger->Error("ODBC Error when " + action + ": " + error);
+    
+    SQLCHAR sqlState[6] = {0};
+    SQLINTEGER nativeError;
+    SQLCHAR message[SQL_MAX_MESSAGE_LENGTH];
+    SQLSMALLINT messageLength;
+    SQLGetDiagRec(handleType, handle, 1, sqlState, &nativeError, message, sizeof(message), &messageLength);
+    
+    lastErrorClass = ClassifySqlState(reinterpret_cast<char*>(sqlState));
+    
+    // OpenEdge reports some broken links as a general HY000 error; the driver knows better
+    if (lastErrorClass == OdbcErrorClass::Statement && IsConnectionDead()) {
+        lastErrorClass = OdbcErrorClass::Connection;
+    }
+    
+    if (lastErrorClass == OdbcErrorClass::Connection) {
+        if (!connectionLost) {
+            logger->Warning("Lost connection to OpenEdge while " + action);
+        }
+        connectionLost = true;
+    }
+    
+    if (lastErrorClass != OdbcErrorClass::Statement) {
+        retryableFailures++;
+    }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 #include <sql.h>
 #include <sqlext.h>
@@ -12,8 +13,48 @@ struct OdbcColumn {
     std::string name;
     SQLSMALLINT dataType;
     SQLULEN columnSize;
+    bool nullable;      // False only when the driver reports SQL_NO_NULLS
 };
 
+// One source index, columns in key order
+struct OdbcIndex {
+    std::string name;
+    bool unique;
+    std::vector<std::string> columns;
+};
+
+// Backing storage for a typed parameter; must stay alive until the statement executes
+struct OdbcParam {
+    std::string text;
+    long long integer;
+    SQL_TIMESTAMP_STRUCT timestamp;
+    SQL_DATE_STRUCT date;
+};
+
+// How a failed call should be handled, decided from its SQLSTATE
+enum class OdbcErrorClass {
+    None,
+    Statement,      // The statement itself is at fault; repeating it fails the same way
+    Transient,      // Lock conflict, deadlock or timeout; the same work may succeed later
+    Connection      // The link to the server is gone; nothing succeeds until a reconnect
+};
+
+// Source reads since the helper was created; callers diff two snapshots
+struct OdbcFetchStats {
+    long long rows;
+    long long bytes;        // Character data returned by GetColumnData
+    double fetchSeconds;    // Time spent in SQLFetch, where the driver waits on the server
+};
+
+// Cumulative write counters from the _TableStat VST; they reset when the database restarts
+struct TableActivity {
+    long long creates;
+    long long updates;
+    long long deletes;
+};
+
+class SourceThrottle;
+
 class OdbcHelper {
 public:
     OdbcHelper(SQLHDBC connection, SQLHENV environment, std::shared_ptr<Logger> logger);
@@ -24,16 +65,48 @@ public:
     // Execute parameterized queries
     SQLHSTMT PrepareStatement(const std::string& sql);
     bool BindParameter(SQLHSTMT statement, int paramIndex, const std::string& value);
+    
+    // Typed binds let the server compare against an index on the column; values must
+    // outlive the execute, as with BindParameter
+    bool BindTimestampParameter(SQLHSTMT statement, int paramIndex, SQL_TIMESTAMP_STRUCT& value);
+    bool BindDateParameter(SQLHSTMT statement, int paramIndex, SQL_DATE_STRUCT& value);
+    
+    // Binds a character value as the given column SQL type; unparseable values fall back to text
+    bool BindTypedParameter(SQLHSTMT statement, int paramIndex, int sqlType, const std::string& value, OdbcParam& storage);
+    
+    // Parses the driver's character form of a DATE or DATETIME: YYYY-MM-DD[ hh:mm:ss[.fraction]]
+    static bool ParseTimestamp(const std::string& text, SQL_TIMESTAMP_STRUCT& timestamp);
     bool ExecutePreparedStatement(SQLHSTMT statement);
     
+    // Closes the open cursor so a prepared statement can be rebound and executed again
+    bool CloseCursor(SQLHSTMT statement);
+    
+    // Longest SQL text the driver accepts; 0 when it reports no limit
+    SQLUINTEGER GetMaxStatementLength();
+    
+    // Switches the connection's isolation for the statements that follow; empty goes back
+    // to the level the connection had before the first switch
+    bool SetIsolationLevel(const std::string& level);
+    static bool ParseIsolationLevel(const std::string& level, SQLUINTEGER& isolation);
+    
     // Fetch row data
     bool FetchRow(SQLHSTMT statement);
+    bool LastFetchFailed() const { return lastFetchFailed; }
+    OdbcFetchStats GetFetchStats() const { return fetchStats; }
+    
+    // Every fetched row is paced through throttle when one is set
+    void SetThrottle(std::shared_ptr<SourceThrottle> throttle) { this->throttle = throttle; }
     std::string GetColumnData(SQLHSTMT statement, int columnIndex);
     
     // Get metadata
     std::vector<OdbcColumn> GetColumns(SQLHSTMT statement);
     std::vector<std::string> GetTableList(const std::string& schema = "");
-    std::string GetPrimaryKeyColumn(const std::string& schema, const std::string& tableName);
+    std::vector<std::string> GetPrimaryKeyColumns(const std::string& schema, const std::string& tableName);
+    std::vector<OdbcIndex> GetIndexes(const std::string& schema, const std::string& tableName);
+    
+    // OpenEdge VSTs; keyed by lowercase table name, empty when the VSTs cannot be read
+    std::map<std::string, TableActivity> GetTableActivity();
+    std::string GetDatabaseStartTime();
     
     // Helper for fetching a batch of rows
     std::vector<std::vector<std::string>> FetchBatch(SQLHSTMT statement, int batchSize);
@@ -43,14 +116,37 @@ public:
     
     // Error checking
     std::string GetLastError(SQLHANDLE handle, SQLSMALLINT handleType);
+    static OdbcErrorClass ClassifySqlState(const std::string& sqlState);
+    OdbcErrorClass LastErrorClass() const { return lastErrorClass; }
+    
+    // Transient and connection failures so far; a change across a table means it was interrupted
+    int RetryableFailures() const { return retryableFailures; }
+    
+    // Set by a connection-class failure, cleared by SetConnection
+    bool ConnectionLost() const { return connectionLost; }
+    bool IsConnectionDead();
+    
+    // Points the helper at a re-established connection
+    void SetConnection(SQLHDBC connection);
 
 private:
     SQLHDBC connection;
     SQLHENV environment;
     std::shared_ptr<Logger> logger;
+    bool lastFetchFailed;
+    OdbcFetchStats fetchStats;
+    std::shared_ptr<SourceThrottle> throttle;
+    OdbcErrorClass lastErrorClass;
+    int retryableFailures;
+    bool connectionLost;
+    SQLUINTEGER maxStatementLength;
+    bool maxStatementLengthKnown;
+    std::string isolationLevel;     // Last level set through SetIsolationLevel on this connection
+    SQLUINTEGER initialIsolation;
     static constexpr size_t SQL_BUFFER_SIZE = 8192;
     
     void CheckError(SQLHANDLE handle, SQLSMALLINT handleType, const std::string& action);
+    SQLHSTMT AllocateStatement();
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "QueryPlanner.h"
+#include <algorithm>
+
+QueryPlanner::QueryPlanner(std::shared_ptr<Logger> logger) : logger(logger) {
+}
+
+QueryPlan QueryPlanner::Plan(const TableInfo& tableInfo, const std::vector<OdbcIndex>& indexes,
+                             const std::string& timestampColumn) {
+    QueryPlan plan;
+    std::string keyIndex;
+    std::string timestampIndex;
+    
+    if (!tableInfo.pkColumns.empty()) {
+        // A composite key is range-scanned on its leading column
+        plan.keyColumn = tableInfo.pkColumns[0];
+        for (const auto& column : tableInfo.pkColumns) {
+            plan.keyTypes.push_back(GetColumnType(tableInfo, column));
+        }
+        plan.keyType = plan.keyTypes[0];
+        keyIndex = FindLeadingIndex(plan.keyColumn, indexes);
+        plan.keyIndexed = !keyIndex.empty();
+    }
+    
+    // Among columns named like a modification time, an indexed one wins, then a real
+    // date/time type, then column order
+    int bestScore = -1;
+    bool configured = !timestampColumn.empty() &&
+        std::find(tableInfo.columns.begin(), tableInfo.columns.end(), timestampColumn) != tableInfo.columns.end();
+    if (!timestampColumn.empty() && !configured) {
+        logger->Warning("Configured timestamp column " + timestampColumn + " not found in " + tableInfo.tableName);
+    }
+    
+    for (const auto& column : tableInfo.columns) {
+        if (configured ? column != timestampColumn : !IsModificationColumn(column)) {
+            continue;
+        }
+        
+        std::string index = FindLeadingIndex(column, indexes);
+        int type = GetColumnType(tableInfo, column);
+        int score = (index.empty() ? 0 : 2) + (IsDateTimeType(type) ? 1 : 0);
+        
+        if (score > bestScore) {
+            bestScore = score;
+            plan.timestampColumn = column;
+            plan.timestampType = type;
+            plan.timestampIndexed = !index.empty();
+            timestampIndex = index;
+        }
+    }
+    
+    std::string summary = "Query plan for " + tableInfo.tableName + ": key ";
+    if (plan.keyColumn.empty()) {
+        summary += "none";
+    } else {
+        for (size_t i = 0; i < tableInfo.pkColumns.size(); ++i) {
+            summary += tableInfo.pkColumns[i] + " " + TypeName(plan.keyTypes[i]) + 
+                       (i < tableInfo.pkColumns.size() - 1 ? ", " : "");
+        }
+        summary += plan.keyIndexed ? " via index " + keyIndex : " without index (table scan)";
+    }
+    
+    summary += ", timestamp ";
+    if (plan.timestampColumn.empty()) {
+        summary += "none";
+    } else {
+        summary += plan.timestampColumn + " " + TypeName(plan.timestampType) + 
+                   (plan.timestampIndexed ? " via index " + timestampIndex : " without index (table scan)");
+    }
+    
+    logger->Info(summary);
+    return plan;
+}
+
+std::string QueryPlanner::FindLeadingIndex(const std::string& column, const std::vector<OdbcIndex>& indexes) {
+    // Only the first index column gives a range scan for a single-column predicate
+    for (const auto& index : indexes) {
+        if (!index.columns.empty() && index.columns[0] == column) {
+            return index.name;
+        }
+    }
+    
+    return "";
+}
+
+bool QueryPlanner::IsModificationColumn(const std::string& column) {
+    std::string lowerCol = column;
+    std::transform(lowerCol.begin(), lowerCol.end(), lowerCol.begin(),
+                  [](unsigned char c) { return std::tolower(c); });
+    
+    // Look for common timestamp column patterns
+    return lowerCol.find("timestamp") != std::string::npos || 
+           lowerCol.find("modified") != std::string::npos ||
+           lowerCol.find("updated") != std::string::npos ||
+           lowerCol.find("changed") != std::string::npos ||
+           lowerCol.find("datetime") != std::string::npos;
+}
+
+bool QueryPlanner::IsDateTimeType(int sqlType) {
+    return sqlType == SQL_TYPE_TIMESTAMP || sqlType == SQL_TIMESTAMP ||
+           sqlType == SQL_TYPE_DATE || sqlType == SQL_DATE;
+}
+
+int QueryPlanner::GetColumnType(const TableInfo& tableInfo, const std::string& column) {
+    for (size_t i = 0; i < tableInfo.columns.size() && i < tableInfo.columnTypes.size(); ++i) {
+        if (tableInfo.columns[i] == column) {
+            return tableInfo.columnTypes[i];
+        }
+    }
+    
+    return SQL_VARCHAR;
+}
+
+std::string QueryPlanner::TypeName(int sqlType) {
+    switch (sqlType) {
+        case SQL_INTEGER: return "INTEGER";
+        case SQL_SMALLINT: return "SMALLINT";
+        case SQL_TINYINT: return "TINYINT";
+        case SQL_BIGINT: return "BIGINT";
+        case SQL_DECIMAL: return "DECIMAL";
+        case SQL_NUMERIC: return "NUMERIC";
+        case SQL_FLOAT:
+        case SQL_REAL:
+        case SQL_DOUBLE: return "FLOAT";
+        case SQL_TYPE_TIMESTAMP:
+        case SQL_TIMESTAMP: return "TIMESTAMP";
+        case SQL_TYPE_DATE:
+        case SQL_DATE: return "DATE";
+        default: return "VARCHAR";
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "OdbcHelper.h"
+#include "TableInfo.h"
+#include "Logger.h"
+
+// Chooses the key and modification-time columns incremental syncs filter on, preferring
+// columns that lead a source index so OpenEdge can range-scan instead of reading the table
+class QueryPlanner {
+public:
+    explicit QueryPlanner(std::shared_ptr<Logger> logger);
+    
+    // A configured timestampColumn replaces the name-based guess
+    QueryPlan Plan(const TableInfo& tableInfo, const std::vector<OdbcIndex>& indexes,
+                   const std::string& timestampColumn = "");
+    
+private:
+    std::shared_ptr<Logger> logger;
+    
+    std::string FindLeadingIndex(const std::string& column, const std::vector<OdbcIndex>& indexes);
+    bool IsModificationColumn(const std::string& column);
+    bool IsDateTimeType(int sqlType);
+    int GetColumnType(const TableInfo& tableInfo, const std::string& column);
+    std::string TypeName(int sqlType);
+};
+
+#endif // QUERY_PLANNER_H
@@ -0,0 +1,61 @@
+#include "SourceGroup.h"
+#include <thread>
+
+SourceGroup::SourceGroup(const Config& config, bool fullSync, const std::vector<std::string>& ignoreTables,
+                         int timeBudgetSeconds) {
+    logger = std::make_shared<Logger>(config.mirrorSettings.logFile);
+    
+    int slots = config.mirrorSettings.maxConcurrentTables > 0 ? 
+        config.mirrorSettings.maxConcurrentTables : static_cast<int>(config.sources.size());
+    scheduler = std::make_shared<SyncScheduler>(slots);
+    
+    std::vector<Config> sourceConfigs;
+    bool hashing = false;
+    for (const auto& source : config.sources) {
+        sourceConfigs.push_back(config.ForSource(source));
+        hashing = hashing || sourceConfigs.back().hashDb.enableHashing;
+    }
+    
+    // One pool sized for the machine, not one per source
+    if (hashing) {
+        hashPool = std::make_shared<HashWorkerPool>(config.mirrorSettings.hashThreads);
+        logger->Info("Started hash worker pool with " + std::to_string(hashPool->GetThreadCount()) + 
+                    " threads for " + std::to_string(config.sources.size()) + " sources");
+    }
+    
+    for (size_t i = 0; i < config.sources.size(); ++i) {
+        auto sourceLogger = std::make_shared<Logger>(logger, config.sources[i].name);
+        managers.push_back(std::make_unique<DataSyncManager>(
+            sourceConfigs[i], fullSync, ignoreTables, timeBudgetSeconds, sourceLogger, hashPool, scheduler));
+    }
+    
+    logger->Info("Mirroring " + std::to_string(managers.size()) + " sources, at most " + 
+                std::to_string(scheduler->GetSlots()) + " tables at a time");
+}
+
+void SourceGroup::RunSync() {
+    RunAll(&DataSyncManager::RunSync);
+}
+
+void SourceGroup::RunDaemon() {
+    DataSyncManager::InstallStopHandlers();
+    RunAll(&DataSyncManager::RunDaemon);
+}
+
+void SourceGroup::RebuildHashes() {
+    for (auto& manager : managers) {
+        manager->RebuildHashes();
+    }
+}
+
+void SourceGroup::RunAll(void (DataSyncManager::*run)()) {
+    std::vector<std::thread> threads;
+    for (auto& manager : managers) {
+        DataSyncManager* source = manager.get();
+        threads.emplace_back([source, run] { (source->*run)(); });
+    }
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
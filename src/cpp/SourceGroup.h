@@ -0,0 +1,35 @@
+#ifndef SOURCE_GROUP_H
+#define SOURCE_GROUP_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Config.h"
+#include "Logger.h"
+#include "HashWorkerPool.h"
+#include "SyncScheduler.h"
+#include "DataSyncManager.h"
+
+// Mirrors every configured source from one process: each source has its own connection,
+// mirror, hash database and ignore list and runs on its own thread, while the log, the
+// hash workers and the table scheduler are shared so sources take turns on CPU and disk
+class SourceGroup {
+public:
+    SourceGroup(const Config& config, bool fullSync, const std::vector<std::string>& ignoreTables,
+                int timeBudgetSeconds);
+    
+    void RunSync();
+    void RunDaemon();
+    // No source is contacted, so mirrors are rebuilt one after another
+    void RebuildHashes();
+
+private:
+    std::shared_ptr<Logger> logger;
+    std::shared_ptr<HashWorkerPool> hashPool;
+    std::shared_ptr<SyncScheduler> scheduler;
+    std::vector<std::unique_ptr<DataSyncManager>> managers;
+    
+    void RunAll(void (DataSyncManager::*run)());
+};
+
+#endif // SOURCE_GROUP_H
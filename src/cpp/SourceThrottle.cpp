@@ -0,0 +1,119 @@
+#include "SourceThrottle.h"
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+
+constexpr double SourceThrottle::MIN_FACTOR;
+
+SourceThrottle::SourceThrottle(const Config& config, std::shared_ptr<Logger> logger)
+    : logger(logger),
+      maxRowsPerSecond(config.mirrorSettings.maxRowsPerSecond),
+      maxBytesPerSecond(config.mirrorSettings.maxBytesPerSecond),
+      adaptive(config.mirrorSettings.adaptiveThrottle),
+      latencyRatio(config.mirrorSettings.throttleLatencyRatio),
+      factor(1.0), baseline(0), latency(0), throttledSeconds(0),
+      lastCheck{0, 0, 0.0} {
+    Clock::time_point now = Clock::now();
+    lastCheckTime = now;
+    lastAdjustTime = now;
+    ResetWindow(now);
+}
+
+bool SourceThrottle::Enabled() const {
+    return maxRowsPerSecond > 0 || maxBytesPerSecond > 0 || adaptive;
+}
+
+void SourceThrottle::BeginTable() {
+    baseline = 0;
+    latency = 0;
+}
+
+void SourceThrottle::Pace(const OdbcFetchStats& stats) {
+    long long rows = stats.rows - lastCheck.rows;
+    if (rows < CHECK_ROWS) {
+        return;
+    }
+    
+    long long bytes = stats.bytes - lastCheck.bytes;
+    double fetchSeconds = stats.fetchSeconds - lastCheck.fetchSeconds;
+    Clock::time_point now = Clock::now();
+    
+    if (std::chrono::duration<double>(now - lastCheckTime).count() > WINDOW_SECONDS) {
+        ResetWindow(now);
+    }
+    lastCheck = stats;
+    lastCheckTime = now;
+    
+    if (adaptive) {
+        AdjustFactor(fetchSeconds / rows, now);
+    }
+    
+    windowRows += rows;
+    windowBytes += bytes;
+    windowFetchSeconds += fetchSeconds;
+    
+    // The time the window's reads should have taken at the current pace; adaptive mode
+    // also stretches time spent waiting on the server, a duty cycle that needs no fixed cap
+    double required = 0;
+    if (maxRowsPerSecond > 0) {
+        required = std::max(required, windowRows / (maxRowsPerSecond * factor));
+    }
+    if (maxBytesPerSecond > 0) {
+        required = std::max(required, windowBytes / (maxBytesPerSecond * factor));
+    }
+    if (adaptive) {
+        required = std::max(required, windowFetchSeconds / factor);
+    }
+    
+    double elapsed = std::chrono::duration<double>(now - windowStart).count();
+    if (required > elapsed) {
+        double pause = required - elapsed;
+        std::this_thread::sleep_for(std::chrono::duration<double>(pause));
+        throttledSeconds += pause;
+        lastCheckTime = Clock::now();
+    }
+    
+    if (std::chrono::duration<double>(lastCheckTime - windowStart).count() > WINDOW_SECONDS) {
+        ResetWindow(lastCheckTime);
+    }
+}
+
+void SourceThrottle::AdjustFactor(double sample, Clock::time_point now) {
+    latency = latency > 0 ? latency * 0.7 + sample * 0.3 : sample;
+    
+    // The baseline follows a faster server at once and a slower one only gradually, so
+    // a table whose rows are simply slower to read is not treated as load forever
+    if (baseline <= 0 || latency < baseline) {
+        baseline = latency;
+    } else {
+        baseline += (latency - baseline) * 0.01;
+    }
+    
+    if (std::chrono::duration<double>(now - lastAdjustTime).count() < ADJUST_SECONDS || baseline <= 0) {
+        return;
+    }
+    
+    char detail[96];
+    snprintf(detail, sizeof(detail), "fetch latency %.3fms per row against a baseline of %.3fms",
+             latency * 1000, baseline * 1000);
+    
+    if (latency > baseline * latencyRatio && factor > MIN_FACTOR) {
+        factor = std::max(MIN_FACTOR, factor * 0.5);
+        lastAdjustTime = now;
+        logger->Info("Source is slowing down (" + std::string(detail) + "), reading at " +
+                    std::to_string(static_cast<int>(factor * 100)) + "% pace");
+    } else if (latency <= baseline * QUIET_RATIO && factor < 1.0) {
+        factor = std::min(1.0, factor * 1.25);
+        lastAdjustTime = now;
+        if (factor == 1.0) {
+            logger->Info("Source is quiet again (" + std::string(detail) + "), reading at full pace");
+        }
+    }
+}
+
+void SourceThrottle::ResetWindow(Clock::time_point now) {
+    windowStart = now;
+    windowRows = 0;
+    windowBytes = 0;
+    windowFetchSeconds = 0;
+}
@@ -0,0 +1,63 @@
+#ifndef SOURCE_THROTTLE_H
+#define SOURCE_THROTTLE_H
+
+#include <chrono>
+#include <memory>
+#include "Config.h"
+#include "Logger.h"
+#include "OdbcHelper.h"
+
+// Paces reads from the source so a sync can run next to production users: fixed caps
+// on rows and bytes per second, and in adaptive mode a speed factor that drops while
+// fetch latency sits above the table's quiet baseline and recovers once it falls back
+class SourceThrottle {
+public:
+    SourceThrottle(const Config& config, std::shared_ptr<Logger> logger);
+    
+    bool Enabled() const;
+    
+    // Called after each fetched row with the helper's running totals; sleeps when reads
+    // are ahead of the allowed pace
+    void Pace(const OdbcFetchStats& stats);
+    
+    // Latency baselines are per table, since row width alone changes fetch time
+    void BeginTable();
+    
+    double GetThrottledSeconds() const { return throttledSeconds; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    std::shared_ptr<Logger> logger;
+    long long maxRowsPerSecond;
+    long long maxBytesPerSecond;
+    bool adaptive;
+    double latencyRatio;
+    
+    double factor;              // Share of the allowed pace currently used, MIN_FACTOR..1
+    double baseline;            // Quiet fetch seconds per row; 0 = not measured yet
+    double latency;             // Smoothed fetch seconds per row
+    double throttledSeconds;
+    
+    OdbcFetchStats lastCheck;
+    Clock::time_point lastCheckTime;
+    Clock::time_point lastAdjustTime;
+    
+    // Pace is measured over a window so a short stall is made up, but an idle gap
+    // between tables is never spent as one burst
+    Clock::time_point windowStart;
+    long long windowRows;
+    long long windowBytes;
+    double windowFetchSeconds;
+    
+    static constexpr long long CHECK_ROWS = 100;
+    static constexpr double WINDOW_SECONDS = 5.0;
+    static constexpr double ADJUST_SECONDS = 1.0;
+    static constexpr double MIN_FACTOR = 0.05;
+    static constexpr double QUIET_RATIO = 1.2;
+    
+    void AdjustFactor(double sample, Clock::time_point now);
+    void ResetWindow(Clock::time_point now);
+};
+
+#endif // SOURCE_THROTTLE_H
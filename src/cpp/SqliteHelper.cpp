@@ -150,4 +150,61 @@ bool SqliteHelper::DeleteRows(const std::string& tableName,
     sql << ")";
     
     return ExecuteNonQuery(sql.str(), whereValues);
-}
\ No newline at end of file
+}
+
+bool SqliteHelper::DeleteRows(const std::string& tableName,
+                             const std::vector<std::string>& whereColumns,
+                             const std::vector<std::vector<std::string>>& whereValues) {
+    
+    if (whereValues.empty()) {
+        return true; // Nothing to delete
+    }
+    
+    // IS matches an empty key part, which is stored as NULL
+    std::ostringstream sql;
+    sql << "DELETE FROM " << tableName << " WHERE ";
+    
+    for (size_t i = 0; i < whereColumns.size(); ++i) {
+        sql << "\"" << whereColumns[i] << "\" IS ?";
+        if (i < whereColumns.size() - 1) {
+            sql << " AND ";
+        }
+    }
+    
+    sqlite3_stmt* stmt = PrepareStatement(sql.str());
+    if (!stmt) {
+        return false;
+    }
+    
+    bool success = true;
+    for (const auto& values : whereValues) {
+        sqlite3_reset(stmt);
+        
+        if (!BindParameters(stmt, values) || sqlite3_step(stmt) != SQLITE_DONE) {
+            logger->Error("Error deleting row: " + std::string(sqlite3_errmsg(connection)));
+            success = false;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+std::string SqliteHelper::GetMaxValue(const std::string& tableName, const std::string& column) {
+    std::string sql = "SELECT MAX(\"" + column + "\") FROM " + tableName;
+    
+    sqlite3_stmt* stmt = PrepareStatement(sql);
+    if (!stmt) {
+        return "";
+    }
+    
+    std::string maxValue;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        maxValue = value ? value : "";
+    }
+    
+    sqlite3_finalize(stmt);
+    return maxValue;
+}
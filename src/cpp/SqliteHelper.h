@@ -34,6 +34,14 @@ public:
     bool DeleteRows(const std::string& tableName, 
                    const std::string& whereColumn,
                    const std::vector<std::string>& whereValues);
+    
+    // Delete rows matching every column of a composite key; one value tuple per row
+    bool DeleteRows(const std::string& tableName,
+                   const std::vector<std::string>& whereColumns,
+                   const std::vector<std::vector<std::string>>& whereValues);
+    
+    // Largest value stored in a column, as text; empty when the table is empty or missing
+    std::string GetMaxValue(const std::string& tableName, const std::string& column);
 
 private:
     sqlite3* connection;
@@ -0,0 +1,114 @@
+#include "StrategyAdvisor.h"
+#include <cstdio>
+
+StrategyAdvisor::StrategyAdvisor(const Config& config) : config(config) {
+}
+
+std::string StrategyAdvisor::Choose(
+    const std::string& baseline,
+    bool hasKey,
+    int tableRows,
+    const std::vector<SyncHistory::RunRecord>& history,
+    std::string& reason) {
+    
+    if (!IsVerifyingStrategy(baseline)) {
+        reason = "only hash strategies are adjusted";
+        return baseline;
+    }
+    
+    // Shortcuts are only trusted while a recent run has checked every row
+    int runsSinceVerify = 0;
+    while (runsSinceVerify < static_cast<int>(history.size()) &&
+           !IsVerifyingStrategy(history[runsSinceVerify].strategy)) {
+        runsSinceVerify++;
+    }
+    
+    if (runsSinceVerify == static_cast<int>(history.size())) {
+        reason = "no verifying run recorded yet";
+        return baseline;
+    }
+    
+    int verifyEvery = config.mirrorSettings.adaptiveVerifyEvery;
+    if (verifyEvery > 0 && runsSinceVerify >= verifyEvery) {
+        reason = std::to_string(runsSinceVerify) + " runs since the last verifying run";
+        return baseline;
+    }
+    
+    long long rowsScanned = 0;
+    long long rowsChanged = 0;
+    long long rowsInPlace = 0;
+    double verifySeconds = 0;
+    int verifiedRuns = 0;
+    
+    long long fullRows = 0;
+    double fullSeconds = 0;
+    
+    for (const auto& run : history) {
+        if (run.rowsScanned <= 0) {
+            continue;
+        }
+        
+        if (run.strategy == "full") {
+            fullRows += run.rowsScanned;
+            fullSeconds += run.totalSeconds;
+        } else if (IsVerifyingStrategy(run.strategy) && verifiedRuns < VERIFIED_RUNS_USED) {
+            rowsScanned += run.rowsScanned;
+            rowsChanged += run.rowsChanged;
+            rowsInPlace += run.rowsUpdated + run.rowsDeleted;
+            verifySeconds += run.totalSeconds;
+            verifiedRuns++;
+        }
+    }
+    
+    if (verifiedRuns < MIN_VERIFIED_RUNS) {
+        reason = "only " + std::to_string(verifiedRuns) + " verifying run(s) recorded";
+        return baseline;
+    }
+    
+    double changeRatio = static_cast<double>(rowsChanged) / rowsScanned;
+    double verifyCost = verifySeconds / verifiedRuns;
+    std::string changes = FormatRatio(changeRatio) + " of rows changed per run over " +
+                          std::to_string(verifiedRuns) + " runs";
+    
+    // Measured reload speed beats the ratio rule of thumb once there is some
+    if (fullRows > 0) {
+        double fullCost = fullSeconds / fullRows * tableRows;
+        std::string costs = "reload estimated at " + FormatSeconds(fullCost) + " against " +
+                            FormatSeconds(verifyCost) + " per " + baseline + " run";
+        
+        if (fullCost < verifyCost) {
+            reason = changes + ", " + costs;
+            return "full";
+        }
+        changes += ", " + costs;
+    } else if (changeRatio >= config.mirrorSettings.fullReloadChangeRatio) {
+        reason = changes + ", at or above the full reload ratio of " +
+                 FormatRatio(config.mirrorSettings.fullReloadChangeRatio);
+        return "full";
+    }
+    
+    // A table that only gains rows is kept current by reading past the key watermark
+    if (hasKey && rowsInPlace == 0) {
+        reason = changes + ", none of them updates or deletes";
+        return "key_based";
+    }
+    
+    reason = changes + ", " + std::to_string(rowsInPlace) + " of them updates or deletes";
+    return baseline;
+}
+
+bool StrategyAdvisor::IsVerifyingStrategy(const std::string& strategy) {
+    return strategy == "hash_based" || strategy == "rolling_hash" || strategy == "multiset";
+}
+
+std::string StrategyAdvisor::FormatRatio(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1f%%", value * 100);
+    return buffer;
+}
+
+std::string StrategyAdvisor::FormatSeconds(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.2fs", value);
+    return buffer;
+}
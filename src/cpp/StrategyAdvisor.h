@@ -0,0 +1,39 @@
+#ifndef STRATEGY_ADVISOR_H
+#define STRATEGY_ADVISOR_H
+
+#include <string>
+#include <vector>
+#include "SyncHistory.h"
+#include "Config.h"
+
+// Cost model over recorded runs: a table whose hash diffs rewrite a large share of it
+// is cheaper to reload, and one that only ever gains rows needs no diff at all.
+// Only the hash strategies are overridden, since only their runs measure what changed
+class StrategyAdvisor {
+public:
+    explicit StrategyAdvisor(const Config& config);
+    
+    // Returns the strategy to run instead of baseline (or baseline itself), with the
+    // reasoning in reason. history is most recent first
+    std::string Choose(
+        const std::string& baseline,
+        bool hasKey,
+        int tableRows,
+        const std::vector<SyncHistory::RunRecord>& history,
+        std::string& reason);
+    
+    static constexpr int HISTORY_WINDOW = 50;
+
+private:
+    const Config& config;
+    
+    // Verified runs averaged per decision, and the fewest worth deciding on
+    static constexpr int VERIFIED_RUNS_USED = 5;
+    static constexpr int MIN_VERIFIED_RUNS = 3;
+    
+    bool IsVerifyingStrategy(const std::string& strategy);
+    std::string FormatRatio(double value);
+    std::string FormatSeconds(double value);
+};
+
+#endif // STRATEGY_ADVISOR_H
@@ -0,0 +1,165 @@
+#include "SyncHistory.h"
+#include <stdexcept>
+#include <algorithm>
+
+SyncHistory::SyncHistory(sqlite3* sqliteConn, std::shared_ptr<Logger> logger)
+    : sqliteConn(sqliteConn), logger(logger) {
+    EnsureHistoryTable();
+}
+
+void SyncHistory::EnsureHistoryTable() {
+    const char* createTableSql =
+        "CREATE TABLE IF NOT EXISTS sync_history ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "table_name TEXT NOT NULL,"
+        "run_id TEXT,"
+        "strategy TEXT,"
+        "finished_at TEXT DEFAULT (datetime('now')),"
+        "rows_scanned INTEGER DEFAULT 0,"
+        "bytes_scanned INTEGER DEFAULT 0,"
+        "rows_changed INTEGER DEFAULT 0,"
+        "rows_inserted INTEGER DEFAULT 0,"
+        "rows_updated INTEGER DEFAULT 0,"
+        "rows_deleted INTEGER DEFAULT 0,"
+        "fetch_seconds REAL DEFAULT 0,"
+        "hash_seconds REAL DEFAULT 0,"
+        "apply_seconds REAL DEFAULT 0,"
+        "total_seconds REAL DEFAULT 0"
+        ");"
+        "CREATE INDEX IF NOT EXISTS idx_sync_history_table ON sync_history (table_name, id)";
+    
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(sqliteConn, createTableSql, nullptr, nullptr, &errMsg);
+    
+    if (rc != SQLITE_OK) {
+        std::string error = "Error creating sync history table: ";
+        if (errMsg) {
+            error += errMsg;
+            sqlite3_free(errMsg);
+        }
+        logger->Error(error);
+        throw std::runtime_error(error);
+    }
+}
+
+void SyncHistory::Record(const RunRecord& record) {
+    const char* insertSql =
+        "INSERT INTO sync_history "
+        "(table_name, run_id, strategy, rows_scanned, bytes_scanned, rows_changed, rows_inserted, "
+        "rows_updated, rows_deleted, fetch_seconds, hash_seconds, apply_seconds, total_seconds) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, insertSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing sync history insert: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, record.tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, record.runId.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, record.strategy.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, record.rowsScanned);
+    sqlite3_bind_int64(stmt, 5, record.bytesScanned);
+    sqlite3_bind_int(stmt, 6, record.rowsChanged);
+    sqlite3_bind_int(stmt, 7, record.rowsInserted);
+    sqlite3_bind_int(stmt, 8, record.rowsUpdated);
+    sqlite3_bind_int(stmt, 9, record.rowsDeleted);
+    sqlite3_bind_double(stmt, 10, record.fetchSeconds);
+    sqlite3_bind_double(stmt, 11, record.hashSeconds);
+    sqlite3_bind_double(stmt, 12, record.applySeconds);
+    sqlite3_bind_double(stmt, 13, record.totalSeconds);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error recording sync history: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+    
+    // Only recent behaviour matters, so each table keeps a bounded window
+    const char* pruneSql =
+        "DELETE FROM sync_history WHERE table_name = ? AND id NOT IN "
+        "(SELECT id FROM sync_history WHERE table_name = ? ORDER BY id DESC LIMIT ?)";
+    
+    if (sqlite3_prepare_v2(sqliteConn, pruneSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        logger->Error("Error preparing sync history prune: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, record.tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, record.tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, RUNS_KEPT_PER_TABLE);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error pruning sync history: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+std::vector<SyncHistory::RunRecord> SyncHistory::GetRecentRuns(const std::string& tableName, int limit) {
+    std::vector<RunRecord> runs;
+    
+    const char* selectSql =
+        "SELECT run_id, strategy, finished_at, rows_scanned, bytes_scanned, rows_changed, rows_inserted, "
+        "rows_updated, rows_deleted, fetch_seconds, hash_seconds, apply_seconds, total_seconds "
+        "FROM sync_history WHERE table_name = ? ORDER BY id DESC LIMIT ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing sync history query: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return runs;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, limit);
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        RunRecord record;
+        record.tableName = tableName;
+        
+        const char* runId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        const char* strategy = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        const char* finishedAt = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        record.runId = runId ? runId : "";
+        record.strategy = strategy ? strategy : "";
+        record.finishedAt = finishedAt ? finishedAt : "";
+        
+        record.rowsScanned = sqlite3_column_int64(stmt, 3);
+        record.bytesScanned = sqlite3_column_int64(stmt, 4);
+        record.rowsChanged = sqlite3_column_int(stmt, 5);
+        record.rowsInserted = sqlite3_column_int(stmt, 6);
+        record.rowsUpdated = sqlite3_column_int(stmt, 7);
+        record.rowsDeleted = sqlite3_column_int(stmt, 8);
+        record.fetchSeconds = sqlite3_column_double(stmt, 9);
+        record.hashSeconds = sqlite3_column_double(stmt, 10);
+        record.applySeconds = sqlite3_column_double(stmt, 11);
+        record.totalSeconds = sqlite3_column_double(stmt, 12);
+        
+        runs.push_back(record);
+    }
+    
+    sqlite3_finalize(stmt);
+    return runs;
+}
+
+double SyncHistory::PredictSeconds(const std::string& tableName, int runs) {
+    std::vector<double> durations;
+    for (const auto& record : GetRecentRuns(tableName, runs)) {
+        durations.push_back(record.totalSeconds);
+    }
+    
+    if (durations.empty()) {
+        return -1;
+    }
+    
+    std::sort(durations.begin(), durations.end());
+    size_t middle = durations.size() / 2;
+    if (durations.size() % 2 == 0) {
+        return (durations[middle - 1] + durations[middle]) / 2;
+    }
+    return durations[middle];
+}
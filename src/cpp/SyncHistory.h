@@ -0,0 +1,51 @@
+#ifndef SYNC_HISTORY_H
+#define SYNC_HISTORY_H
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include "Logger.h"
+
+// One row per table per sync run, kept in the mirror next to sync_state so strategy
+// selection can be based on how each table actually behaved
+class SyncHistory {
+public:
+    SyncHistory(sqlite3* sqliteConn, std::shared_ptr<Logger> logger);
+    
+    struct RunRecord {
+        std::string tableName;
+        std::string runId;
+        std::string strategy;
+        std::string finishedAt;
+        long long rowsScanned;      // Rows fetched from the source
+        long long bytesScanned;
+        int rowsChanged;            // Rows the strategy reported as synced
+        int rowsInserted;           // Split of rowsChanged where the strategy knows it
+        int rowsUpdated;
+        int rowsDeleted;
+        double fetchSeconds;        // Waiting on the source
+        double hashSeconds;         // Hashing on the worker pool
+        double applySeconds;        // Everything else: reading columns, diffing, writing the mirror
+        double totalSeconds;
+    };
+    
+    void Record(const RunRecord& record);
+    
+    // Most recent first
+    std::vector<RunRecord> GetRecentRuns(const std::string& tableName, int limit);
+    
+    // Median duration of the last runs runs; the median keeps one initial reload from
+    // dominating. -1 when the table has no history
+    double PredictSeconds(const std::string& tableName, int runs);
+
+private:
+    sqlite3* sqliteConn;
+    std::shared_ptr<Logger> logger;
+    
+    static constexpr int RUNS_KEPT_PER_TABLE = 100;
+    
+    void EnsureHistoryTable();
+};
+
+#endif // SYNC_HISTORY_H
@@ -0,0 +1,46 @@
+#include "SyncScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+SyncScheduler::SyncScheduler(int slots)
+    : slots(std::max(1, slots)), freeSlots(std::max(1, slots)), nextTicket(0) {
+}
+
+double SyncScheduler::Acquire(double priority) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    auto request = std::make_pair(priority, -nextTicket++);
+    waiting.insert(request);
+    slotFreed.wait(lock, [this, &request] {
+        return freeSlots > 0 && *waiting.rbegin() == request;
+    });
+    
+    waiting.erase(request);
+    freeSlots--;
+    
+    // The next waiter may fit into another free slot
+    slotFreed.notify_all();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SyncScheduler::Release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeSlots++;
+    }
+    slotFreed.notify_all();
+}
+
+SyncScheduler::Slot::Slot(SyncScheduler* scheduler, double priority)
+    : scheduler(scheduler), waitSeconds(0) {
+    if (scheduler) {
+        waitSeconds = scheduler->Acquire(priority);
+    }
+}
+
+SyncScheduler::Slot::~Slot() {
+    if (scheduler) {
+        scheduler->Release();
+    }
+}
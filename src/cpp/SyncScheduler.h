@@ -0,0 +1,50 @@
+#ifndef SYNC_SCHEDULER_H
+#define SYNC_SCHEDULER_H
+
+#include <set>
+#include <mutex>
+#include <utility>
+#include <condition_variable>
+
+// Admits table syncs from every source of a multi-source run, a fixed number at a time.
+// A free slot goes to the waiting table with the highest priority, oldest request first
+// on ties, so one source with many overdue tables cannot crowd the others out
+class SyncScheduler {
+public:
+    explicit SyncScheduler(int slots);
+    
+    SyncScheduler(const SyncScheduler&) = delete;
+    SyncScheduler& operator=(const SyncScheduler&) = delete;
+    
+    int GetSlots() const { return slots; }
+    
+    // Holds a slot for its lifetime; a null scheduler admits at once
+    class Slot {
+    public:
+        Slot(SyncScheduler* scheduler, double priority);
+        ~Slot();
+        
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+        
+        double GetWaitSeconds() const { return waitSeconds; }
+    
+    private:
+        SyncScheduler* scheduler;
+        double waitSeconds;
+    };
+
+private:
+    int slots;
+    int freeSlots;
+    long long nextTicket;
+    std::set<std::pair<double, long long>> waiting;  // (priority, -ticket); last is next
+    std::mutex mutex;
+    std::condition_variable slotFreed;
+    
+    // Blocks until the table may start; returns the seconds spent waiting
+    double Acquire(double priority);
+    void Release();
+};
+
+#endif // SYNC_SCHEDULER_H
@@ -29,14 +29,79 @@ void SyncState::EnsureStateTable() {
         throw std::runtime_error(error);
     }
     
+    EnsureStateColumn("key_column", "TEXT");
+    EnsureStateColumn("key_kind", "TEXT");
+    EnsureStateColumn("verify_cursor", "TEXT");
+    EnsureStateColumn("timestamp_watermark", "TEXT");
+    EnsureStateColumn("stat_epoch", "TEXT");
+    EnsureStateColumn("stat_creates", "INTEGER");
+    EnsureStateColumn("stat_updates", "INTEGER");
+    EnsureStateColumn("stat_deletes", "INTEGER");
+    EnsureStateColumn("checkpoint_strategy", "TEXT");
+    EnsureStateColumn("checkpoint_key", "TEXT");
+    EnsureStateColumn("checkpoint_run", "TEXT");
+    EnsureStateColumn("checkpoint_rows", "INTEGER");
+    EnsureStateColumn("deferred_runs", "INTEGER");
+    EnsureStateColumn("cdc_sequence", "INTEGER");
+    EnsureStateColumn("batch_size", "INTEGER");
+    
     logger->Info("Ensured sync state table exists");
 }
 
+void SyncState::EnsureStateColumn(const std::string& columnName, const std::string& columnDef) {
+    // State tables written by older versions are extended in place
+    std::string pragmaSql = "PRAGMA table_info(sync_state)";
+    sqlite3_stmt* stmt = nullptr;
+    
+    if (sqlite3_prepare_v2(sqliteConn, pragmaSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        logger->Error("Error reading sync state columns: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* colName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (colName && columnName == colName) {
+            exists = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    if (exists) {
+        return;
+    }
+    
+    std::string alterSql = "ALTER TABLE sync_state ADD COLUMN " + columnName + " " + columnDef;
+    char* errMsg = nullptr;
+    
+    if (sqlite3_exec(sqliteConn, alterSql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string error = "Error adding " + columnName + " to sync state table: ";
+        if (errMsg) {
+            error += errMsg;
+            sqlite3_free(errMsg);
+        }
+        logger->Error(error);
+        throw std::runtime_error(error);
+    }
+    
+    logger->Info("Added " + columnName + " to sync state table");
+}
+
 SyncState::SyncData SyncState::GetLastSync(const std::string& tableName) {
     SyncData result;
+    result.rowCount = 0;
+    result.statCreates = 0;
+    result.statUpdates = 0;
+    result.statDeletes = 0;
+    result.checkpointRows = 0;
+    result.deferredRuns = 0;
+    result.cdcSequence = -1;
+    result.batchSize = 0;
     
     const char* selectSql = 
-        "SELECT last_sync_time, last_key_value, sync_method, row_count "
+        "SELECT last_sync_time, last_key_value, sync_method, row_count, key_column, verify_cursor, "
+        "stat_epoch, stat_creates, stat_updates, stat_deletes, timestamp_watermark, key_kind, "
+        "checkpoint_strategy, checkpoint_key, checkpoint_run, checkpoint_rows, deferred_runs, cdc_sequence, batch_size "
         "FROM sync_state "
         "WHERE table_name = ?";
     
@@ -59,6 +124,37 @@ SyncState::SyncData SyncState::GetLastSync(const std::string& tableName) {
         result.lastKeyValue = keyValue ? keyValue : "";
         result.syncMethod = method ? method : "timestamp";
         result.rowCount = sqlite3_column_int(stmt, 3);
+        
+        const char* keyColumn = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+        result.keyColumn = keyColumn ? keyColumn : "";
+        
+        const char* verifyCursor = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+        result.verifyCursor = verifyCursor ? verifyCursor : "";
+        
+        const char* statEpoch = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
+        result.statEpoch = statEpoch ? statEpoch : "";
+        result.statCreates = sqlite3_column_int64(stmt, 7);
+        result.statUpdates = sqlite3_column_int64(stmt, 8);
+        result.statDeletes = sqlite3_column_int64(stmt, 9);
+        
+        const char* watermark = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 10));
+        result.timestampWatermark = watermark ? watermark : "";
+        
+        const char* keyKind = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 11));
+        result.keyKind = keyKind ? keyKind : "";
+        
+        const char* checkpointStrategy = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
+        const char* checkpointKey = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 13));
+        const char* checkpointRun = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
+        result.checkpointStrategy = checkpointStrategy ? checkpointStrategy : "";
+        result.checkpointKey = checkpointKey ? checkpointKey : "";
+        result.checkpointRun = checkpointRun ? checkpointRun : "";
+        result.checkpointRows = sqlite3_column_int(stmt, 15);
+        result.deferredRuns = sqlite3_column_int(stmt, 16);
+        if (sqlite3_column_type(stmt, 17) != SQLITE_NULL) {
+            result.cdcSequence = sqlite3_column_int64(stmt, 17);
+        }
+        result.batchSize = sqlite3_column_int(stmt, 18);
     }
     
     sqlite3_finalize(stmt);
@@ -69,10 +165,16 @@ void SyncState::UpdateSyncState(const std::string& tableName,
                               const std::string& lastKeyValue, 
                               const std::string& syncMethod, 
                               int rowCount) {
+    // Upsert so columns maintained elsewhere (key_column, ...) survive the update
     const char* updateSql = 
-        "INSERT OR REPLACE INTO sync_state "
+        "INSERT INTO sync_state "
         "(table_name, last_sync_time, last_key_value, sync_method, row_count) "
-        "VALUES (?, datetime('now'), ?, ?, ?)";
+        "VALUES (?, datetime('now'), ?, ?, ?) "
+        "ON CONFLICT(table_name) DO UPDATE SET "
+        "last_sync_time = excluded.last_sync_time, "
+        "last_key_value = excluded.last_key_value, "
+        "sync_method = excluded.sync_method, "
+        "row_count = excluded.row_count";
     
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
@@ -96,4 +198,269 @@ void SyncState::UpdateSyncState(const std::string& tableName,
     }
     
     sqlite3_finalize(stmt);
-}
\ No newline at end of file
+}
+
+void SyncState::SetKeyColumn(const std::string& tableName, const std::string& keyColumn, const std::string& keyKind) {
+    const char* updateSql = 
+        "INSERT INTO sync_state (table_name, key_column, key_kind) VALUES (?, ?, ?) "
+        "ON CONFLICT(table_name) DO UPDATE SET key_column = excluded.key_column, key_kind = excluded.key_kind";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing key column update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, keyColumn.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, keyKind.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating key column: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+long long SyncState::GetSecondsSinceSync(const std::string& tableName) {
+    const char* selectSql = 
+        "SELECT CAST(strftime('%s', 'now') AS INTEGER) - CAST(strftime('%s', last_sync_time) AS INTEGER) "
+        "FROM sync_state WHERE table_name = ? AND last_sync_time IS NOT NULL";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing sync age query: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    long long seconds = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        seconds = sqlite3_column_int64(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    return seconds;
+}
+
+std::vector<std::string> SyncState::GetTablesWithKeys() {
+    std::vector<std::string> tables;
+    
+    const char* selectSql = 
+        "SELECT table_name FROM sync_state "
+        "WHERE key_column IS NOT NULL AND key_column <> '' "
+        "ORDER BY table_name";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, selectSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing keyed table query: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return tables;
+    }
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* tableName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (tableName) {
+            tables.push_back(tableName);
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    return tables;
+}
+
+void SyncState::SetVerifyCursor(const std::string& tableName, const std::string& cursor) {
+    const char* updateSql = "UPDATE sync_state SET verify_cursor = ? WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing verify cursor update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, cursor.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating verify cursor: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+void SyncState::SetTimestampWatermark(const std::string& tableName, const std::string& watermark) {
+    const char* updateSql = "UPDATE sync_state SET timestamp_watermark = ? WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing timestamp watermark update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, watermark.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating timestamp watermark: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+void SyncState::SetCheckpoint(const std::string& tableName, const std::string& strategy, const std::string& runId,
+                              const std::string& lastKey, int rowsDone) {
+    // Upsert: a table's first full sync is checkpointed before it has any sync state
+    const char* updateSql = 
+        "INSERT INTO sync_state "
+        "(table_name, checkpoint_strategy, checkpoint_key, checkpoint_run, checkpoint_rows) "
+        "VALUES (?, ?, ?, ?, ?) "
+        "ON CONFLICT(table_name) DO UPDATE SET "
+        "checkpoint_strategy = excluded.checkpoint_strategy, "
+        "checkpoint_key = excluded.checkpoint_key, "
+        "checkpoint_run = excluded.checkpoint_run, "
+        "checkpoint_rows = excluded.checkpoint_rows";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing checkpoint update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, strategy.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, lastKey.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, runId.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 5, rowsDone);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating checkpoint: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+void SyncState::ClearCheckpoint(const std::string& tableName) {
+    const char* updateSql = 
+        "UPDATE sync_state SET checkpoint_strategy = NULL, checkpoint_key = NULL, "
+        "checkpoint_run = NULL, checkpoint_rows = NULL WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing checkpoint reset: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error clearing checkpoint: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+void SyncState::SetCdcSequence(const std::string& tableName, long long sequence) {
+    const char* updateSql = "UPDATE sync_state SET cdc_sequence = ? WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing CDC sequence update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_int64(stmt, 1, sequence);
+    sqlite3_bind_text(stmt, 2, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating CDC sequence: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+void SyncState::SetBatchSize(const std::string& tableName, int batchSize) {
+    const char* updateSql = "UPDATE sync_state SET batch_size = ? WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing batch size update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_int(stmt, 1, batchSize);
+    sqlite3_bind_text(stmt, 2, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating batch size: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+void SyncState::SetDeferred(const std::string& tableName, bool deferred) {
+    // Tables never synced have no state row yet, so deferral inserts one
+    const char* deferSql = 
+        "INSERT INTO sync_state (table_name, deferred_runs) VALUES (?, 1) "
+        "ON CONFLICT(table_name) DO UPDATE SET deferred_runs = COALESCE(deferred_runs, 0) + 1";
+    const char* resetSql = "UPDATE sync_state SET deferred_runs = 0 WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, deferred ? deferSql : resetSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing deferral update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating deferral: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
+
+void SyncState::SetTableActivity(const std::string& tableName, const std::string& epoch,
+                                 long long creates, long long updates, long long deletes) {
+    const char* updateSql = 
+        "UPDATE sync_state SET stat_epoch = ?, stat_creates = ?, stat_updates = ?, stat_deletes = ? "
+        "WHERE table_name = ?";
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(sqliteConn, updateSql, -1, &stmt, nullptr);
+    
+    if (rc != SQLITE_OK) {
+        logger->Error("Error preparing table activity update: " + std::string(sqlite3_errmsg(sqliteConn)));
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, epoch.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, creates);
+    sqlite3_bind_int64(stmt, 3, updates);
+    sqlite3_bind_int64(stmt, 4, deletes);
+    sqlite3_bind_text(stmt, 5, tableName.c_str(), -1, SQLITE_STATIC);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        logger->Error("Error updating table activity: " + std::string(sqlite3_errmsg(sqliteConn)));
+    }
+    
+    sqlite3_finalize(stmt);
+}
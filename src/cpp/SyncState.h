@@ -3,6 +3,7 @@
 
 #include <sqlite3.h>
 #include <string>
+#include <vector>
 #include <memory>
 #include "Logger.h"
 
@@ -15,19 +16,71 @@ public:
         std::string lastKeyValue;
         std::string syncMethod;
         int rowCount;
+        std::string keyColumn;
+        std::string keyKind;
+        std::string verifyCursor;
+        std::string timestampWatermark;   // Largest source timestamp read by a timestamp sync
+        
+        // Progress of a sync that has not finished; empty strategy when none is pending
+        std::string checkpointStrategy;
+        std::string checkpointKey;
+        std::string checkpointRun;
+        int checkpointRows;
+        
+        int deferredRuns;   // Consecutive --time-budget runs that left the table out
+        long long cdcSequence;  // Last CDC change applied to the mirror; -1 before the first reload
+        int batchSize;      // Batch size the table settled on under auto_batch_size; 0 = none yet
+        
+        // _TableStat snapshot from the last sync that completed without errors
+        std::string statEpoch;
+        long long statCreates;
+        long long statUpdates;
+        long long statDeletes;
     };
     
     SyncData GetLastSync(const std::string& tableName);
+    // Age of the last completed sync; -1 when the table has never been synced
+    long long GetSecondsSinceSync(const std::string& tableName);
     void UpdateSyncState(const std::string& tableName, 
                         const std::string& lastKeyValue = "", 
                         const std::string& syncMethod = "timestamp", 
                         int rowCount = 0);
+    
+    // Key column the table was mirrored with and where it came from; lets the mirror be
+    // processed without the source
+    void SetKeyColumn(const std::string& tableName, const std::string& keyColumn, const std::string& keyKind);
+    std::vector<std::string> GetTablesWithKeys();
+    
+    // Last key hash-verified by the rolling window; empty restarts at the first key
+    void SetVerifyCursor(const std::string& tableName, const std::string& cursor);
+    
+    // Source-side high-water mark for timestamp sync, stored as the text the driver returned
+    void SetTimestampWatermark(const std::string& tableName, const std::string& watermark);
+    
+    // Mid-table checkpoint, written inside the batch transaction it describes so the
+    // mirror and its checkpoint always agree
+    void SetCheckpoint(const std::string& tableName, const std::string& strategy, const std::string& runId,
+                       const std::string& lastKey, int rowsDone);
+    void ClearCheckpoint(const std::string& tableName);
+    
+    // CDC watermark, written inside the batch transaction that applied the changes up to it
+    void SetCdcSequence(const std::string& tableName, long long sequence);
+    
+    void SetBatchSize(const std::string& tableName, int batchSize);
+    
+    // Counts runs whose time budget left the table out; false resets the count
+    void SetDeferred(const std::string& tableName, bool deferred);
+    
+    // Write counters the table was last synced at; an empty epoch forgets the snapshot
+    void SetTableActivity(const std::string& tableName, const std::string& epoch,
+                          long long creates, long long updates, long long deletes);
 
 private:
     sqlite3* sqliteConn;
     std::shared_ptr<Logger> logger;
     
     void EnsureStateTable();
+    void EnsureStateColumn(const std::string& columnName, const std::string& columnDef);
 };
 
 #endif
\ No newline at end of file
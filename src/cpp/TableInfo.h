@@ -4,10 +4,29 @@
 #include <string>
 #include <vector>
 
+// Columns used for incremental predicates and the SQL types their parameters are bound as
+struct QueryPlan {
+    std::string keyColumn;          // Leading key column
+    int keyType = 0;
+    std::vector<int> keyTypes;      // One per primary key column, in key order
+    bool keyIndexed = false;
+    std::string timestampColumn;
+    int timestampType = 0;
+    bool timestampIndexed = false;
+};
+
 struct TableInfo {
     std::string tableName;
     std::vector<std::string> columns;
-    std::string pkColumn;
+    std::vector<int> columnTypes;   // ODBC SQL type per column, same order as columns
+    std::vector<std::string> pkColumns;   // Primary key columns in KEY_SEQ order; empty when keyless
+    std::string keyKind;                  // "primary_key", "unique_index <name>", "rowid" or empty
+    std::string rowidColumn;              // Mirror column read from the source ROWID; empty when not mirrored
+    std::string digestColumn;             // Mirror-only row digest tag of a keyless table; empty when unused
+    std::string cdcTable;                 // Qualified OpenEdge CDC change table; empty when changes are not captured
+    std::string sourceFilter;             // Configured source WHERE condition; empty when the whole table is mirrored
+    std::vector<std::string> excludedColumns; // Source columns the table's column lists leave out of the mirror
+    QueryPlan plan;
 };
 
 #endif
\ No newline at end of file
@@ -1,22 +1,48 @@
 #include <set>
 #include "TableSyncer.h"
 #include "HashCalculator.h"
+#include "KeyCodec.h"
 #include <algorithm>
 #include <stdexcept>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <ctime>
 
 TableSyncer::TableSyncer(SqliteHelper& sqliteHelper, 
                          OdbcHelper& odbcHelper,
                          std::shared_ptr<SyncState> syncState,
+                         std::shared_ptr<SyncHistory> syncHistory,
                          std::shared_ptr<HashStorage> hashDb,
+                         std::shared_ptr<HashWorkerPool> hashPool,
                          std::shared_ptr<Logger> logger,
+                         const Config& config,
                          int batchSize)
     : sqliteHelper(sqliteHelper), 
       odbcHelper(odbcHelper),
       syncState(syncState),
+      syncHistory(syncHistory),
       hashDb(hashDb),
+      hashPool(hashPool),
       logger(logger),
+      config(config),
       batchSize(batchSize),
-      hashEnabled(hashDb != nullptr) {
+      defaultBatchSize(batchSize),
+      hashEnabled(hashDb != nullptr),
+      advisor(config),
+      batchSizer(config),
+      tuneBatches(false),
+      runStats{0, 0, 0, 0.0} {
+    // Each source thread builds its own syncer, so localtime's shared buffer is off limits
+    char stamp[32];
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    runId = stamp;
 }
 
 int TableSyncer::SyncTable(const TableInfo& tableInfo, bool fullSync) {
@@ -27,9 +53,49 @@ int TableSyncer::SyncTable(const TableInfo& tableInfo, bool fullSync) {
         return 0;
     }
     
+    // Watermarks and hashes recorded under a different key no longer identify rows
+    std::string keyColumn = KeyCodec::JoinColumns(tableInfo.pkColumns);
+    std::string previousKey = syncState->GetLastSync(tableName).keyColumn;
+    // Mirror rows loaded before a ROWID key existed have no ROWID to match on
+    if (previousKey != keyColumn && (!previousKey.empty() || !tableInfo.rowidColumn.empty())) {
+        logger->Warning("Key of " + tableName + " changed from " + (previousKey.empty() ? "none" : previousKey) + " to " + 
+                       (keyColumn.empty() ? "none" : keyColumn) + ", running a full sync");
+        if (hashEnabled) {
+            hashDb->DeleteTableHashes(tableName);
+        }
+        syncState->ClearCheckpoint(tableName);
+        fullSync = true;
+    }
+    
+    syncState->SetKeyColumn(tableName, keyColumn, tableInfo.keyKind);
+    
+    odbcHelper.SetIsolationLevel(GetIsolationLevel(tableName));
+    
     std::string strategy = GetSyncStrategy(tableInfo, fullSync);
+    std::string configuredStrategy = strategy == "full" ? "" : GetConfiguredStrategy(tableInfo);
+    // A configured strategy replaces the automatic choice, but never a reload that is due
+    if (!configuredStrategy.empty()) {
+        strategy = configuredStrategy;
+    } else if (config.mirrorSettings.adaptiveStrategy && !fullSync && 
+               syncState->GetLastSync(tableName).checkpointStrategy.empty()) {
+        // Forced reloads and pending resumes keep the strategy that was decided for them
+        strategy = AdviseStrategy(tableInfo, strategy);
+    }
     logger->Info("Using " + strategy + " sync strategy for " + tableName);
     
+    runStats = RunStats{0, 0, 0, 0.0};
+    OdbcFetchStats fetchStart = odbcHelper.GetFetchStats();
+    auto start = std::chrono::steady_clock::now();
+    
+    int tableBatchSize = GetTableBatchSize(tableName);
+    tuneBatches = tableBatchSize == 0 && batchSizer.Enabled();
+    if (tuneBatches) {
+        batchSize = batchSizer.Begin(syncState->GetLastSync(tableName).batchSize, fetchStart);
+    } else {
+        batchSize = tableBatchSize > 0 ? tableBatchSize : defaultBatchSize;
+    }
+    int startBatchSize = batchSize;
+    
     int rowsSynced = 0;
     if (strategy == "full") {
         rowsSynced = SyncFullTable(tableInfo);
@@ -37,16 +103,79 @@ int TableSyncer::SyncTable(const TableInfo& tableInfo, bool fullSync) {
         rowsSynced = SyncKeyBased(tableInfo);
     } else if (strategy == "hash_based") {
         rowsSynced = SyncHashBased(tableInfo);
+    } else if (strategy == "rolling_hash") {
+        rowsSynced = SyncRollingHash(tableInfo);
     } else if (strategy == "timestamp") {
         rowsSynced = SyncTimestampBased(tableInfo);
+    } else if (strategy == "multiset") {
+        rowsSynced = SyncMultiset(tableInfo);
+    } else if (strategy == "cdc") {
+        rowsSynced = SyncCdc(tableInfo);
+    }
+    
+    RecordRun(tableInfo, strategy, rowsSynced, fetchStart, start);
+    
+    if (tuneBatches) {
+        syncState->SetBatchSize(tableName, batchSize);
+        if (batchSize != startBatchSize) {
+            logger->Info("Batch size for " + tableName + " tuned from " + std::to_string(startBatchSize) + 
+                        " to " + std::to_string(batchSize) + " rows");
+        }
     }
     
     return rowsSynced;
 }
 
+void TableSyncer::TuneBatchSize() {
+    if (tuneBatches) {
+        batchSize = batchSizer.Next(odbcHelper.GetFetchStats());
+    }
+}
+
+std::string TableSyncer::AdviseStrategy(const TableInfo& tableInfo, const std::string& strategy) {
+    const std::string& tableName = tableInfo.tableName;
+    
+    auto history = syncHistory->GetRecentRuns(tableName, StrategyAdvisor::HISTORY_WINDOW);
+    int tableRows = syncState->GetLastSync(tableName).rowCount;
+    
+    std::string reason;
+    std::string chosen = advisor.Choose(strategy, !tableInfo.pkColumns.empty(), tableRows, history, reason);
+    
+    if (chosen != strategy) {
+        logger->Info("Strategy for " + tableName + ": " + chosen + " instead of " + strategy + " (" + reason + ")");
+    } else {
+        logger->Info("Strategy for " + tableName + ": keeping " + strategy + " (" + reason + ")");
+    }
+    
+    return chosen;
+}
+
+void TableSyncer::RecordRun(const TableInfo& tableInfo, const std::string& strategy, int rowsSynced,
+                            const OdbcFetchStats& fetchStart, std::chrono::steady_clock::time_point start) {
+    OdbcFetchStats fetched = odbcHelper.GetFetchStats();
+    
+    SyncHistory::RunRecord record;
+    record.tableName = tableInfo.tableName;
+    record.runId = runId;
+    record.strategy = strategy;
+    record.rowsScanned = fetched.rows - fetchStart.rows;
+    record.bytesScanned = fetched.bytes - fetchStart.bytes;
+    record.rowsChanged = rowsSynced;
+    record.rowsInserted = runStats.rowsInserted;
+    record.rowsUpdated = runStats.rowsUpdated;
+    record.rowsDeleted = runStats.rowsDeleted;
+    record.fetchSeconds = fetched.fetchSeconds - fetchStart.fetchSeconds;
+    record.hashSeconds = runStats.hashSeconds;
+    record.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // Hashing overlaps fetching on the worker pool, so the remainder is only an estimate
+    record.applySeconds = std::max(0.0, record.totalSeconds - record.fetchSeconds - record.hashSeconds);
+    
+    syncHistory->Record(record);
+}
+
 std::string TableSyncer::GetSyncStrategy(const TableInfo& tableInfo, bool fullSync) {
     const std::string& tableName = tableInfo.tableName;
-    const std::string& pkColumn = tableInfo.pkColumn;
+    bool hasKey = !tableInfo.pkColumns.empty();
     
     if (fullSync) {
         return "full";
@@ -54,83 +183,144 @@ std::string TableSyncer::GetSyncStrategy(const TableInfo& tableInfo, bool fullSy
     
     auto lastSync = syncState->GetLastSync(tableName);
     
-    if (lastSync.lastSyncTime.empty()) {
+    // A reload that did not finish leaves the mirror partial until it is completed
+    if (lastSync.lastSyncTime.empty() || lastSync.checkpointStrategy == "full") {
         return "full";
     }
     
-    if (hashEnabled && !pkColumn.empty()) {
+    // The change feed is authoritative once a reload has anchored it
+    if (!tableInfo.cdcTable.empty()) {
+        return "cdc";
+    }
+    
+    // An interrupted full hash scan is finished before rolling verification takes over
+    if (hashEnabled && hasKey && lastSync.checkpointStrategy == "hash_based") {
+        return "hash_based";
+    }
+    
+    if (hashEnabled && !tableInfo.digestColumn.empty()) {
+        return "multiset";
+    }
+    
+    if (hashEnabled && hasKey) {
+        if (UseRollingVerification(tableName, lastSync.rowCount)) {
+            return "rolling_hash";
+        }
         return "hash_based";
     }
     
-    if (!pkColumn.empty()) {
+    if (hasKey) {
         return "key_based";
     }
     
     return "timestamp";
 }
 
+std::string TableSyncer::GetConfiguredStrategy(const TableInfo& tableInfo) {
+    auto it = config.tables.find(tableInfo.tableName);
+    if (it == config.tables.end() || it->second.strategy.empty()) {
+        return "";
+    }
+    
+    const std::string& strategy = it->second.strategy;
+    bool hasKey = !tableInfo.pkColumns.empty();
+    bool usable = false;
+    
+    if (strategy == "full") {
+        usable = true;
+    } else if (strategy == "key_based") {
+        usable = hasKey;
+    } else if (strategy == "hash_based" || strategy == "rolling_hash") {
+        usable = hashEnabled && hasKey;
+    } else if (strategy == "multiset") {
+        usable = hashEnabled && !tableInfo.digestColumn.empty();
+    } else if (strategy == "timestamp") {
+        usable = !tableInfo.plan.timestampColumn.empty();
+    } else if (strategy == "cdc") {
+        usable = !tableInfo.cdcTable.empty();
+    } else {
+        logger->Warning("Unknown strategy " + strategy + " configured for " + tableInfo.tableName);
+        return "";
+    }
+    
+    if (!usable) {
+        logger->Warning("Table " + tableInfo.tableName + " cannot use its configured " + strategy + 
+                       " strategy, choosing one automatically");
+        return "";
+    }
+    
+    return strategy;
+}
+
 int TableSyncer::SyncFullTable(const TableInfo& tableInfo) {
     const std::string& tableName = tableInfo.tableName;
     const std::vector<std::string>& columns = tableInfo.columns;
-    const std::string& pkColumn = tableInfo.pkColumn;
+    bool hasKey = !tableInfo.pkColumns.empty();
+    
+    int totalRows = GetSourceRowCount(tableInfo);
     
-    int totalRows = GetSourceRowCount(tableName);
+    // A keyed reload continues after its last committed key; a keyless one can only start over
+    auto lastSync = syncState->GetLastSync(tableName);
+    bool resume = hasKey && lastSync.checkpointStrategy == "full" && !lastSync.checkpointKey.empty();
     
     try {
-        // Delete all existing data
-        if (!sqliteHelper.ExecuteNonQuery("DELETE FROM " + tableName)) {
-            return 0;
+        if (resume) {
+            logger->Info("Resuming full sync of " + tableName + " from run " + lastSync.checkpointRun + 
+                        " after key '" + lastSync.checkpointKey + "' (" + std::to_string(lastSync.checkpointRows) + 
+                        " rows already loaded)");
+        } else {
+            // Changes captured from here on are replayed over the reload, so any made during it are kept
+            long long cdcStart = -1;
+            if (!tableInfo.cdcTable.empty() && !QueryCdcHighWater(tableInfo, cdcStart)) {
+                return 0;
+            }
+            
+            // Delete all existing data; the full checkpoint marks the mirror as partial until the end
+            sqliteHelper.BeginTransaction();
+            if (!sqliteHelper.ExecuteNonQuery("DELETE FROM " + tableName)) {
+                sqliteHelper.RollbackTransaction();
+                return 0;
+            }
+            syncState->SetCheckpoint(tableName, "full", runId, "", 0);
+            if (cdcStart >= 0) {
+                syncState->SetCdcSequence(tableName, cdcStart);
+            }
+            sqliteHelper.CommitTransaction();
         }
         
         // Prepare the query for source data
-        std::string selectSql = "SELECT ";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            selectSql += "\"" + columns[i] + "\"";
-            if (i < columns.size() - 1) {
-                selectSql += ", ";
-            }
+        std::string selectSql = "SELECT " + SelectList(tableInfo);
+        selectSql += " FROM PUB." + tableName + SourceWhere(tableInfo, resume ? KeyPredicate(tableInfo, ">") : "");
+        
+        // Key order makes the last row read the key-based watermark and the resume point
+        if (hasKey) {
+            selectSql += " ORDER BY " + KeyColumnList(tableInfo);
         }
-        selectSql += " FROM PUB." + tableName;
         
-        SQLHSTMT stmt = odbcHelper.ExecuteQuery(selectSql);
+        SQLHSTMT stmt = odbcHelper.PrepareStatement(selectSql);
         if (stmt == SQL_NULL_HSTMT) {
             return 0;
         }
         
+        int paramIndex = 1;
+        std::deque<OdbcParam> keyParams;
+        if ((resume && !BindKeyPredicate(stmt, paramIndex, tableInfo, lastSync.checkpointKey, keyParams)) ||
+            !odbcHelper.ExecutePreparedStatement(stmt)) {
+            odbcHelper.FreeStatement(stmt);
+            return 0;
+        }
+        
         // Begin transaction
         sqliteHelper.BeginTransaction();
         
-        int rowsSynced = 0;
-        std::string lastValue;
-        int pkIndex = -1;
-        
-        if (!pkColumn.empty()) {
-            for (size_t i = 0; i < columns.size(); ++i) {
-                if (columns[i] == pkColumn) {
-                    pkIndex = static_cast<int>(i);
-                    break;
-                }
-            }
-        }
+        int resumedRows = resume ? lastSync.checkpointRows : 0;
+        int rowsSynced = resumedRows;
+        int batchRows = 0;
+        std::string lastValue = resume ? lastSync.checkpointKey : "";
+        std::vector<int> keyIndexes = GetKeyIndexes(tableInfo);
         
         // Prepare insert statement
-        std::string insertSql = "INSERT INTO " + tableName + " (";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            insertSql += "\"" + columns[i] + "\"";
-            if (i < columns.size() - 1) {
-                insertSql += ", ";
-            }
-        }
-        insertSql += ") VALUES (";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            insertSql += "?";
-            if (i < columns.size() - 1) {
-                insertSql += ", ";
-            }
-        }
-        insertSql += ")";
-        
-        sqlite3_stmt* insertStmt = sqliteHelper.PrepareStatement(insertSql);
+        sqlite3_stmt* insertStmt = sqliteHelper.PrepareStatement(BuildInsertSql(tableInfo));
         if (!insertStmt) {
             odbcHelper.FreeStatement(stmt);
             sqliteHelper.RollbackTransaction();
@@ -144,10 +334,11 @@ int TableSyncer::SyncFullTable(const TableInfo& tableInfo) {
             for (size_t i = 0; i < columns.size(); ++i) {
                 std::string value = odbcHelper.GetColumnData(stmt, i + 1);
                 rowData.push_back(value);
-                
-                if (static_cast<int>(i) == pkIndex) {
-                    lastValue = value;
-                }
+            }
+            
+            std::string pkValue = KeyCodec::Extract(rowData, keyIndexes);
+            if (!pkValue.empty()) {
+                lastValue = pkValue;
             }
             
             // Reset statement and bind parameters
@@ -157,45 +348,66 @@ int TableSyncer::SyncFullTable(const TableInfo& tableInfo) {
                 sqliteHelper.BindParameter(insertStmt, i + 1, rowData[i]);
             }
             
+            // Keyless rows are tagged so the next multiset diff can match them
+            if (!tableInfo.digestColumn.empty()) {
+                sqliteHelper.BindParameter(insertStmt, rowData.size() + 1, HashCalculator::CalculateRowHash(rowData));
+            }
+            
             // Execute insert
             int rc = sqlite3_step(insertStmt);
             if (rc != SQLITE_DONE) {
                 logger->Error("Error inserting row: " + std::string(sqlite3_errmsg(sqlite3_db_handle(insertStmt))));
             } else {
                 rowsSynced++;
+                batchRows++;
                 
                 // If hash-based sync is enabled, store the hash
-                if (hashEnabled && pkIndex >= 0 && !rowData[pkIndex].empty()) {
+                if (hashEnabled && !pkValue.empty()) {
                     std::string rowHash = HashCalculator::CalculateRowHash(rowData);
-                    hashDb->StoreHash(tableName, rowData[pkIndex], rowHash);
+                    std::string columnHashes = HashCalculator::CalculateColumnHashes(rowData, hashDb->GetColumnGroupSize());
+                    hashDb->StoreHash(tableName, pkValue, rowHash, columnHashes);
                 }
             }
             
-            if (rowsSynced % batchSize == 0) {
+            if (batchRows >= batchSize) {
+                syncState->SetCheckpoint(tableName, "full", runId, hasKey ? lastValue : "", rowsSynced);
                 sqliteHelper.CommitTransaction();
                 sqliteHelper.BeginTransaction();
                 
                 float progressPct = (totalRows > 0) ? static_cast<float>(rowsSynced) / totalRows * 100 : 0;
-                logger->Info("Inserted " + std::to_string(batchSize) + " rows for " + tableName + 
+                logger->Info("Inserted " + std::to_string(batchRows) + " rows for " + tableName + 
                             " (total: " + std::to_string(rowsSynced) + " of " + std::to_string(totalRows) + 
                             " (" + std::to_string(progressPct) + "%)");
+                batchRows = 0;
+                TuneBatchSize();
             }
         }
         
-        // Finalize statements and commit transaction
         sqlite3_finalize(insertStmt);
-        sqliteHelper.CommitTransaction();
+        bool scanComplete = !odbcHelper.LastFetchFailed();
         odbcHelper.FreeStatement(stmt);
+        runStats.rowsInserted += rowsSynced - resumedRows;
+        
+        // An interrupted scan keeps its checkpoint, so the next run resumes instead of trusting the mirror
+        if (!scanComplete) {
+            syncState->SetCheckpoint(tableName, "full", runId, hasKey ? lastValue : "", rowsSynced);
+            sqliteHelper.CommitTransaction();
+            logger->Warning("Full sync of " + tableName + " stopped after " + std::to_string(rowsSynced) + 
+                           " rows; the next run " + (hasKey ? "resumes from the checkpoint" : "reloads the table"));
+            return rowsSynced - resumedRows;
+        }
         
-        // Update sync state
-        if (!pkColumn.empty() && !lastValue.empty()) {
+        // Sync state and checkpoint are committed with the last batch
+        if (!keyIndexes.empty() && !lastValue.empty()) {
             syncState->UpdateSyncState(tableName, lastValue, "key_based", rowsSynced);
         } else {
             syncState->UpdateSyncState(tableName, "", "timestamp", rowsSynced);
         }
+        syncState->ClearCheckpoint(tableName);
+        sqliteHelper.CommitTransaction();
         
         logger->Info("Completed full sync of " + tableName + ": " + std::to_string(rowsSynced) + " rows");
-        return rowsSynced;
+        return rowsSynced - resumedRows;
     } catch (const std::exception& e) {
         logger->Error("Error performing full sync of " + tableName + ": " + e.what());
         sqliteHelper.RollbackTransaction();
@@ -206,9 +418,8 @@ int TableSyncer::SyncFullTable(const TableInfo& tableInfo) {
 int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
     const std::string& tableName = tableInfo.tableName;
     const std::vector<std::string>& columns = tableInfo.columns;
-    const std::string& pkColumn = tableInfo.pkColumn;
     
-    if (pkColumn.empty()) {
+    if (tableInfo.pkColumns.empty()) {
         logger->Warning("Table " + tableName + " has no primary key, falling back to full sync");
         return SyncFullTable(tableInfo);
     }
@@ -221,16 +432,27 @@ int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
         return SyncFullTable(tableInfo);
     }
     
+    // Batches an interrupted run already committed are not fetched again
+    int resumedRows = 0;
+    if (lastSync.checkpointStrategy == "key_based" && !lastSync.checkpointKey.empty()) {
+        logger->Info("Resuming key-based sync of " + tableName + " from run " + lastSync.checkpointRun + 
+                    " after key '" + lastSync.checkpointKey + "'");
+        lastKeyValue = lastSync.checkpointKey;
+        resumedRows = lastSync.checkpointRows;
+    }
+    
     try {
         // Count new/changed rows
-        std::string countSql = "SELECT COUNT(*) FROM PUB." + tableName + " WHERE \"" + pkColumn + "\" > ?";
+        std::string countSql = "SELECT COUNT(*) FROM PUB." + tableName + SourceWhere(tableInfo, KeyPredicate(tableInfo, ">"));
         SQLHSTMT countStmt = odbcHelper.PrepareStatement(countSql);
         
         if (countStmt == SQL_NULL_HSTMT) {
             return 0;
         }
         
-        if (!odbcHelper.BindParameter(countStmt, 1, lastKeyValue)) {
+        int countParam = 1;
+        std::deque<OdbcParam> countKey;
+        if (!BindKeyPredicate(countStmt, countParam, tableInfo, lastKeyValue, countKey)) {
             odbcHelper.FreeStatement(countStmt);
             return 0;
         }
@@ -250,25 +472,28 @@ int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
         logger->Info("Found " + std::to_string(totalNewRows) + " new/changed rows to sync for " + tableName);
         
         if (totalNewRows == 0) {
+            if (resumedRows > 0) {
+                sqliteHelper.BeginTransaction();
+                syncState->UpdateSyncState(tableName, lastKeyValue, "key_based", lastSync.rowCount + resumedRows);
+                syncState->ClearCheckpoint(tableName);
+                sqliteHelper.CommitTransaction();
+            }
             return 0;
         }
         
         // Query for new/changed rows
-        std::string selectSql = "SELECT ";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            selectSql += "\"" + columns[i] + "\"";
-            if (i < columns.size() - 1) {
-                selectSql += ", ";
-            }
-        }
-        selectSql += " FROM PUB." + tableName + " WHERE \"" + pkColumn + "\" > ? ORDER BY \"" + pkColumn + "\"";
+        std::string selectSql = "SELECT " + SelectList(tableInfo);
+        selectSql += " FROM PUB." + tableName + SourceWhere(tableInfo, KeyPredicate(tableInfo, ">")) + 
+                     " ORDER BY " + KeyColumnList(tableInfo);
         
         SQLHSTMT selectStmt = odbcHelper.PrepareStatement(selectSql);
         if (selectStmt == SQL_NULL_HSTMT) {
             return 0;
         }
         
-        if (!odbcHelper.BindParameter(selectStmt, 1, lastKeyValue)) {
+        int selectParam = 1;
+        std::deque<OdbcParam> selectKey;
+        if (!BindKeyPredicate(selectStmt, selectParam, tableInfo, lastKeyValue, selectKey)) {
             odbcHelper.FreeStatement(selectStmt);
             return 0;
         }
@@ -278,16 +503,10 @@ int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
             return 0;
         }
         
-        // Find the primary key column index
-        int pkIndex = -1;
-        for (size_t i = 0; i < columns.size(); ++i) {
-            if (columns[i] == pkColumn) {
-                pkIndex = static_cast<int>(i);
-                break;
-            }
-        }
+        // Find the primary key column indexes
+        std::vector<int> keyIndexes = GetKeyIndexes(tableInfo);
         
-        if (pkIndex == -1) {
+        if (keyIndexes.empty()) {
             logger->Error("Could not find primary key column in result set");
             odbcHelper.FreeStatement(selectStmt);
             return 0;
@@ -303,23 +522,20 @@ int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
         
         while (odbcHelper.FetchRow(selectStmt)) {
             std::vector<std::string> rowData;
-            std::string currentPk;
             
             for (size_t i = 0; i < columns.size(); ++i) {
                 std::string value = odbcHelper.GetColumnData(selectStmt, i + 1);
                 rowData.push_back(value);
-                
-                if (static_cast<int>(i) == pkIndex) {
-                    currentPk = value;
-                    lastValue = value;
-                }
             }
             
+            std::string currentPk = KeyCodec::Extract(rowData, keyIndexes);
+            lastValue = currentPk;
+            
             batchData.push_back(rowData);
             pkValues.push_back(currentPk);
             
             if (batchData.size() >= static_cast<size_t>(batchSize)) {
-                ProcessKeyBasedBatch(tableName, columns, pkColumn, pkValues, batchData);
+                ProcessKeyBasedBatch(tableName, columns, tableInfo.pkColumns, pkValues, batchData);
                 
                 rowsSynced += batchData.size();
                 float progressPct = (totalNewRows > 0) ? static_cast<float>(rowsSynced) / totalNewRows * 100 : 0;
@@ -330,21 +546,35 @@ int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
                 pkValues.clear();
                 batchData.clear();
                 
+                syncState->SetCheckpoint(tableName, "key_based", runId, lastValue, resumedRows + rowsSynced);
                 sqliteHelper.CommitTransaction();
                 sqliteHelper.BeginTransaction();
+                TuneBatchSize();
             }
         }
         
         if (!batchData.empty()) {
-            ProcessKeyBasedBatch(tableName, columns, pkColumn, pkValues, batchData);
+            ProcessKeyBasedBatch(tableName, columns, tableInfo.pkColumns, pkValues, batchData);
             rowsSynced += batchData.size();
         }
         
-        sqliteHelper.CommitTransaction();
+        bool scanComplete = !odbcHelper.LastFetchFailed();
         odbcHelper.FreeStatement(selectStmt);
+        runStats.rowsInserted += rowsSynced;
+        
+        // The watermark only moves past rows that were all read; otherwise the checkpoint carries on
+        if (!scanComplete) {
+            syncState->SetCheckpoint(tableName, "key_based", runId, lastValue, resumedRows + rowsSynced);
+            sqliteHelper.CommitTransaction();
+            logger->Warning("Key-based sync of " + tableName + " stopped after key '" + lastValue + 
+                           "'; the next run resumes from the checkpoint");
+            return rowsSynced;
+        }
         
-        int totalRows = lastSync.rowCount + rowsSynced;
+        int totalRows = lastSync.rowCount + resumedRows + rowsSynced;
         syncState->UpdateSyncState(tableName, lastValue, "key_based", totalRows);
+        syncState->ClearCheckpoint(tableName);
+        sqliteHelper.CommitTransaction();
         
         logger->Info("Completed key-based sync of " + tableName + ": " + std::to_string(rowsSynced) + " new/changed rows");
         return rowsSynced;
@@ -358,7 +588,7 @@ int TableSyncer::SyncKeyBased(const TableInfo& tableInfo) {
 void TableSyncer::ProcessKeyBasedBatch(
     const std::string& tableName, 
     const std::vector<std::string>& columns, 
-    const std::string& pkColumn,
+    const std::vector<std::string>& pkColumns,
     const std::vector<std::string>& pkValues, 
     const std::vector<std::vector<std::string>>& batchData) {
     
@@ -368,7 +598,7 @@ void TableSyncer::ProcessKeyBasedBatch(
     
     try {
         // Delete existing rows
-        if (!sqliteHelper.DeleteRows(tableName, pkColumn, pkValues)) {
+        if (!DeleteKeyedRows(tableName, pkColumns, pkValues)) {
             logger->Error("Error deleting existing rows for key-based sync");
             return;
         }
@@ -412,7 +642,8 @@ void TableSyncer::ProcessKeyBasedBatch(
             } else if (hashEnabled && !pkValue.empty()) {
                 // Update hash in the hash database when key-based sync is used
                 std::string rowHash = HashCalculator::CalculateRowHash(row);
-                hashDb->StoreHash(tableName, pkValue, rowHash);
+                std::string columnHashes = HashCalculator::CalculateColumnHashes(row, hashDb->GetColumnGroupSize());
+                hashDb->StoreHash(tableName, pkValue, rowHash, columnHashes);
             }
         }
         
@@ -434,8 +665,8 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
     }
     
     try {
-        // Find a timestamp or date/time column
-        std::string timestampColumn = FindTimestampColumn(columns);
+        // Chosen by the planner, preferring an indexed date/time column
+        const std::string& timestampColumn = tableInfo.plan.timestampColumn;
         
         if (timestampColumn.empty()) {
             logger->Warning("No timestamp column found for " + tableName + ", falling back to full sync");
@@ -444,18 +675,51 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
         
         logger->Info("Using timestamp column: " + timestampColumn + " for table " + tableName);
         
-        // Query for changes since last sync
-        std::string selectSql = "SELECT ";
+        // The lower bound is the largest value read from the source column itself, never the
+        // local clock; tables synced before the watermark existed start from the mirror's maximum
+        std::string watermark = lastSync.timestampWatermark;
+        if (watermark.empty()) {
+            watermark = sqliteHelper.GetMaxValue(tableName, timestampColumn);
+        }
+        
+        if (watermark.empty()) {
+            logger->Warning("No timestamp watermark for " + tableName + ", falling back to full sync");
+            return SyncFullTable(tableInfo);
+        }
+        
+        SQL_TIMESTAMP_STRUCT watermarkTs;
+        bool watermarkParsed = OdbcHelper::ParseTimestamp(watermark, watermarkTs);
+        
+        int timestampIndex = -1;
         for (size_t i = 0; i < columns.size(); ++i) {
-            selectSql += "\"" + columns[i] + "\"";
-            if (i < columns.size() - 1) {
-                selectSql += ", ";
+            if (columns[i] == timestampColumn) {
+                timestampIndex = static_cast<int>(i);
+                break;
             }
         }
-        selectSql += " FROM PUB." + tableName + " WHERE \"" + timestampColumn + "\" > ?";
         
-        if (!tableInfo.pkColumn.empty()) {
-            selectSql += " ORDER BY \"" + tableInfo.pkColumn + "\"";
+        // The watermark can only move if the column is read
+        if (timestampIndex < 0) {
+            logger->Warning("Timestamp column " + timestampColumn + " of " + tableName + 
+                           " is not mirrored, falling back to full sync");
+            return SyncFullTable(tableInfo);
+        }
+        
+        // Bound in the column's own type so the server can use an index on it
+        int timestampType = tableInfo.plan.timestampType;
+        bool timestampBound = watermarkParsed && (timestampType == SQL_TYPE_TIMESTAMP || timestampType == SQL_TIMESTAMP);
+        bool dateBound = watermarkParsed && (timestampType == SQL_TYPE_DATE || timestampType == SQL_DATE);
+        
+        // Only a typed bound re-reads an overlap window; a text bound reads strictly past the watermark
+        bool overlap = timestampBound || dateBound;
+        
+        // Query for changes since last sync
+        std::string selectSql = "SELECT " + SelectList(tableInfo);
+        selectSql += " FROM PUB." + tableName + 
+                     SourceWhere(tableInfo, "\"" + timestampColumn + "\" " + (overlap ? ">=" : ">") + " ?");
+        
+        if (!tableInfo.pkColumns.empty()) {
+            selectSql += " ORDER BY " + KeyColumnList(tableInfo);
         }
         
         SQLHSTMT stmt = odbcHelper.PrepareStatement(selectSql);
@@ -463,10 +727,31 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
             return 0;
         }
         
-        // Format the timestamp as expected by the database
-        std::string formattedTimestamp = lastSync.lastSyncTime;
+        // Rows committed late with an older timestamp are caught by re-reading an overlap window
+        SQL_TIMESTAMP_STRUCT lowerTs = watermarkTs;
+        if (watermarkParsed) {
+            ShiftTimestamp(lowerTs, -config.mirrorSettings.timestampOverlapSeconds);
+        }
+        SQL_DATE_STRUCT lowerDate = {lowerTs.year, lowerTs.month, lowerTs.day};
+        
+        bool bound;
+        if (timestampBound) {
+            bound = odbcHelper.BindTimestampParameter(stmt, 1, lowerTs);
+        } else if (dateBound) {
+            bound = odbcHelper.BindDateParameter(stmt, 1, lowerDate);
+        } else {
+            logger->Warning("Binding " + timestampColumn + " of " + tableName + " as text, without overlap");
+            bound = odbcHelper.BindParameter(stmt, 1, watermark);
+        }
+        
+        if (!bound) {
+            odbcHelper.FreeStatement(stmt);
+            return 0;
+        }
         
-        if (!odbcHelper.BindParameter(stmt, 1, formattedTimestamp)) {
+        // Mirrored copies of the overlap window, read once and matched by full row image
+        std::unordered_map<std::string, int> overlapCopies;
+        if (overlap && !LoadOverlapRows(tableInfo, FormatTimestamp(lowerTs, dateBound), overlapCopies)) {
             odbcHelper.FreeStatement(stmt);
             return 0;
         }
@@ -476,6 +761,11 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
             return 0;
         }
         
+        std::string maxSeen = watermark;
+        SQL_TIMESTAMP_STRUCT maxSeenTs = watermarkTs;
+        int overlapRows = 0;
+        int duplicateRows = 0;
+        
         // Process rows in batches
         sqliteHelper.BeginTransaction();
         
@@ -483,40 +773,52 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
         std::vector<std::string> pkValues;
         std::vector<std::vector<std::string>> batchData;
         
-        int pkIndex = -1;
-        if (!tableInfo.pkColumn.empty()) {
-            for (size_t i = 0; i < columns.size(); ++i) {
-                if (columns[i] == tableInfo.pkColumn) {
-                    pkIndex = static_cast<int>(i);
-                    break;
-                }
-            }
-        }
+        std::vector<int> keyIndexes = GetKeyIndexes(tableInfo);
+        bool keyed = !keyIndexes.empty();
         
         while (odbcHelper.FetchRow(stmt)) {
             std::vector<std::string> rowData;
-            std::string pkValue;
             
             for (size_t i = 0; i < columns.size(); ++i) {
                 std::string value = odbcHelper.GetColumnData(stmt, i + 1);
                 rowData.push_back(value);
+            }
+            
+            std::string pkValue = keyed ? KeyCodec::Extract(rowData, keyIndexes) : "";
+            
+            // Rows at or below the old watermark were probably mirrored already; skip exact copies
+            SQL_TIMESTAMP_STRUCT rowTs;
+            if (!overlap) {
+                if (IsLaterValue(rowData[timestampIndex], maxSeen)) {
+                    maxSeen = rowData[timestampIndex];
+                }
+            } else if (OdbcHelper::ParseTimestamp(rowData[timestampIndex], rowTs)) {
+                if (CompareTimestamps(rowTs, maxSeenTs) > 0) {
+                    maxSeenTs = rowTs;
+                    maxSeen = rowData[timestampIndex];
+                }
                 
-                if (pkIndex >= 0 && static_cast<int>(i) == pkIndex) {
-                    pkValue = value;
+                // Each mirrored copy absorbs one re-read row, so repeated keyless rows stay counted
+                if (CompareTimestamps(rowTs, watermarkTs) <= 0) {
+                    overlapRows++;
+                    auto copy = overlapCopies.find(KeyCodec::Encode(rowData));
+                    if (copy != overlapCopies.end() && copy->second > 0) {
+                        copy->second--;
+                        duplicateRows++;
+                        continue;
+                    }
                 }
             }
             
-            if (pkIndex >= 0 && !pkValue.empty()) {
+            if (keyed) {
                 pkValues.push_back(pkValue);
-            } else if (pkIndex >= 0) {
-                pkValues.push_back("");
             }
             
             batchData.push_back(rowData);
             
             if (batchData.size() >= static_cast<size_t>(batchSize)) {
-                if (pkIndex >= 0) {
-                    ProcessKeyBasedBatch(tableName, columns, tableInfo.pkColumn, 
+                if (keyed) {
+                    ProcessKeyBasedBatch(tableName, columns, tableInfo.pkColumns, 
                                        pkValues, batchData);
                 } else {
                     // For tables without PKs, insert rows directly
@@ -561,12 +863,13 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
                 
                 sqliteHelper.CommitTransaction();
                 sqliteHelper.BeginTransaction();
+                TuneBatchSize();
             }
         }
         
         if (!batchData.empty()) {
-            if (pkIndex >= 0) {
-                ProcessKeyBasedBatch(tableName, columns, tableInfo.pkColumn, 
+            if (keyed) {
+                ProcessKeyBasedBatch(tableName, columns, tableInfo.pkColumns, 
                                    pkValues, batchData);
             } else {
                 // Same approach for remaining rows without PKs
@@ -605,19 +908,30 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
         }
         
         sqliteHelper.CommitTransaction();
+        
+        // Rows arrive in key order, so a broken scan says nothing about timestamps not yet read
+        bool scanComplete = !odbcHelper.LastFetchFailed();
         odbcHelper.FreeStatement(stmt);
         
         // Update the last sync time
         std::string lastKeyValue = "";
-        if (pkIndex >= 0 && !pkValues.empty()) {
+        if (keyed && !pkValues.empty()) {
             lastKeyValue = pkValues.back();
         }
         
         int totalRows = lastSync.rowCount + rowsSynced;
         syncState->UpdateSyncState(tableName, lastKeyValue, "timestamp", totalRows);
         
+        if (scanComplete) {
+            syncState->SetTimestampWatermark(tableName, maxSeen);
+        } else {
+            logger->Warning("Source scan of " + tableName + " did not complete, keeping timestamp watermark " + watermark);
+        }
+        
         logger->Info("Completed timestamp-based sync of " + tableName + ": " + 
-                   std::to_string(rowsSynced) + " changed rows");
+                   std::to_string(rowsSynced) + " changed rows, " + std::to_string(overlapRows) + 
+                   " rows re-read from the overlap window (" + std::to_string(duplicateRows) + 
+                   " already mirrored), watermark " + (scanComplete ? maxSeen : watermark));
         
         return rowsSynced;
     } catch (const std::exception& e) {
@@ -629,142 +943,99 @@ int TableSyncer::SyncTimestampBased(const TableInfo& tableInfo) {
 
 int TableSyncer::SyncHashBased(const TableInfo& tableInfo) {
     const std::string& tableName = tableInfo.tableName;
-    const std::vector<std::string>& columns = tableInfo.columns;
-    const std::string& pkColumn = tableInfo.pkColumn;
     
-    if (pkColumn.empty() || !hashEnabled || !hashDb) {
+    if (tableInfo.pkColumns.empty() || !hashEnabled || !hashDb) {
         logger->Warning("Unable to use hash-based sync for " + tableName + ", falling back to key-based");
         return SyncKeyBased(tableInfo);
     }
     
+    // An interrupted full scan continues with keyset pagination after its checkpoint
+    auto lastSync = syncState->GetLastSync(tableName);
+    bool resume = lastSync.checkpointStrategy == "hash_based" && !lastSync.checkpointKey.empty();
+    
+    int bucketRows = GetFingerprintBucketRows(tableName);
+    if (bucketRows > 0 && !resume) {
+        const std::string& modColumn = tableInfo.plan.timestampColumn;
+        if (!modColumn.empty()) {
+            return SyncHashFingerprinted(tableInfo, modColumn, bucketRows);
+        }
+        logger->Warning("No modification column found in " + tableName + 
+                       ", range fingerprints cannot see updates; scanning all rows");
+    }
+    
     try {
         // Query all rows
-        std::string selectSql = "SELECT ";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            selectSql += "\"" + columns[i] + "\"";
-            if (i < columns.size() - 1) {
-                selectSql += ", ";
-            }
-        }
-        selectSql += " FROM PUB." + tableName + " ORDER BY \"" + pkColumn + "\"";
+        std::string selectSql = "SELECT " + SelectList(tableInfo);
+        selectSql += " FROM PUB." + tableName + SourceWhere(tableInfo, resume ? KeyPredicate(tableInfo, ">") : "");
+        selectSql += " ORDER BY " + KeyColumnList(tableInfo);
         
-        SQLHSTMT stmt = odbcHelper.ExecuteQuery(selectSql);
+        SQLHSTMT stmt = odbcHelper.PrepareStatement(selectSql);
         if (stmt == SQL_NULL_HSTMT) {
             return 0;
         }
         
-        // Find the primary key column index
-        int pkIndex = -1;
-        for (size_t i = 0; i < columns.size(); ++i) {
-            if (columns[i] == pkColumn) {
-                pkIndex = static_cast<int>(i);
-                break;
-            }
+        int paramIndex = 1;
+        std::deque<OdbcParam> keyParams;
+        if ((resume && !BindKeyPredicate(stmt, paramIndex, tableInfo, lastSync.checkpointKey, keyParams)) ||
+            !odbcHelper.ExecutePreparedStatement(stmt)) {
+            odbcHelper.FreeStatement(stmt);
+            return 0;
         }
         
-        if (pkIndex == -1) {
+        // Find the primary key column indexes
+        std::vector<int> keyIndexes = GetKeyIndexes(tableInfo);
+        
+        if (keyIndexes.empty()) {
             logger->Error("Could not find primary key column in result set");
             odbcHelper.FreeStatement(stmt);
             return 0;
         }
         
-        // Process rows in batches
-        sqliteHelper.BeginTransaction();
-        
-        int rowsSynced = 0;
-        std::vector<std::string> pkValues;
-        std::vector<std::string> rowHashes;
-        std::vector<std::vector<std::string>> batchData;
-        
-        while (odbcHelper.FetchRow(stmt)) {
-            std::vector<std::string> rowData;
-            std::string pkValue;
-            
-            for (size_t i = 0; i < columns.size(); ++i) {
-                std::string value = odbcHelper.GetColumnData(stmt, i + 1);
-                rowData.push_back(value);
-                
-                if (static_cast<int>(i) == pkIndex) {
-                    pkValue = value;
-                }
-            }
-            
-            if (!pkValue.empty()) {
-                std::string rowHash = HashCalculator::CalculateRowHash(rowData);
-                pkValues.push_back(pkValue);
-                rowHashes.push_back(rowHash);
-                batchData.push_back(rowData);
-            }
-            
-            if (batchData.size() >= static_cast<size_t>(batchSize)) {
-                auto changedRows = hashDb->GetChangedRows(tableName, pkValues, rowHashes);
-                
-                if (!changedRows.empty()) {
-                    std::vector<std::string> changedPks;
-                    std::vector<std::vector<std::string>> changedData;
-                    
-                    for (size_t i = 0; i < pkValues.size(); ++i) {
-                        auto it = std::find(changedRows.begin(), changedRows.end(), pkValues[i]);
-                        if (it != changedRows.end()) {
-                            changedPks.push_back(pkValues[i]);
-                            changedData.push_back(batchData[i]);
-                        }
-                    }
-                    
-                    if (!changedPks.empty()) {
-                        ProcessHashBasedBatch(tableName, columns, pkColumn, changedPks, changedData);
-                        rowsSynced += changedPks.size();
-                    }
-                }
-                
-                logger->Info("Processed " + std::to_string(batchData.size()) + " rows for " + tableName + 
-                           ", found " + std::to_string(changedRows.size()) + " changes");
-                
-                pkValues.clear();
-                rowHashes.clear();
-                batchData.clear();
-                
-                sqliteHelper.CommitTransaction();
-                sqliteHelper.BeginTransaction();
+        // Keys before the checkpoint are not read again, so a resumed scan cannot prove deletes
+        bool trackDeletes = false;
+        if (resume) {
+            logger->Info("Resuming hash-based sync of " + tableName + " from run " + lastSync.checkpointRun + 
+                        " after key '" + lastSync.checkpointKey + "'; deletes are detected by the next full scan");
+        } else {
+            trackDeletes = hashDb->BeginSeenTracking();
+            if (!trackDeletes) {
+                logger->Warning("Delete detection disabled for " + tableName + " in this run");
             }
         }
         
-        if (!batchData.empty()) {
-            auto changedRows = hashDb->GetChangedRows(tableName, pkValues, rowHashes);
-            
-            if (!changedRows.empty()) {
-                std::vector<std::string> changedPks;
-                std::vector<std::vector<std::string>> changedData;
-                
-                for (size_t i = 0; i < pkValues.size(); ++i) {
-                    auto it = std::find(changedRows.begin(), changedRows.end(), pkValues[i]);
-                    if (it != changedRows.end()) {
-                        changedPks.push_back(pkValues[i]);
-                        changedData.push_back(batchData[i]);
-                    }
-                }
-                
-                if (!changedPks.empty()) {
-                    ProcessHashBasedBatch(tableName, columns, pkColumn, changedPks, changedData);
-                    rowsSynced += changedPks.size();
-                }
-            }
-            
-            logger->Info("Processed final " + std::to_string(batchData.size()) + " rows for " + tableName + 
-                       ", found " + std::to_string(changedRows.size()) + " changes");
-        }
+        std::string lastKey;
+        int rowsRead = resume ? lastSync.checkpointRows : 0;
+        bool seenTracked = trackDeletes;
+        int rowsSynced = RunHashPipeline(tableInfo, stmt, keyIndexes, 0, seenTracked, true, lastKey, rowsRead);
         
-        sqliteHelper.CommitTransaction();
+        // Only a scan that ran to the end, with every key it read marked seen, proves that unseen keys were deleted
+        bool scanComplete = !odbcHelper.LastFetchFailed();
         odbcHelper.FreeStatement(stmt);
         
+        int rowsDeleted = 0;
+        if (trackDeletes && seenTracked && scanComplete) {
+            rowsDeleted = ApplyHashDeletes(tableInfo, hashDb->GetUnseenKeys(tableName));
+        } else if (!scanComplete) {
+            logger->Warning("Source scan of " + tableName + " did not complete, skipping delete detection");
+        }
+        
         logger->Info("Completed hash-based sync of " + tableName + ": " + 
-                    std::to_string(rowsSynced) + " changed rows");
+                    std::to_string(rowsSynced) + " changed rows, " + 
+                    std::to_string(rowsDeleted) + " deleted rows");
         
-        auto lastSync = syncState->GetLastSync(tableName);
-        int totalRows = lastSync.rowCount;
-        syncState->UpdateSyncState(tableName, "", "hash_based", totalRows);
+        // A complete ordered scan ends on the highest key, which seeds key-based and rolling syncs
+        lastSync = syncState->GetLastSync(tableName);
+        int totalRows = std::max(0, lastSync.rowCount - rowsDeleted);
+        std::string keyWatermark = (scanComplete && !lastKey.empty()) ? lastKey : lastSync.lastKeyValue;
         
-        return rowsSynced;
+        sqliteHelper.BeginTransaction();
+        syncState->UpdateSyncState(tableName, keyWatermark, "hash_based", totalRows);
+        if (scanComplete) {
+            syncState->ClearCheckpoint(tableName);
+        }
+        sqliteHelper.CommitTransaction();
+        
+        return rowsSynced + rowsDeleted;
     } catch (const std::exception& e) {
         logger->Error("Error performing hash-based sync of " + tableName + ": " + e.what());
         sqliteHelper.RollbackTransaction();
@@ -772,28 +1043,1303 @@ int TableSyncer::SyncHashBased(const TableInfo& tableInfo) {
     }
 }
 
-void TableSyncer::ProcessHashBasedBatch(
-    const std::string& tableName,
-    const std::vector<std::string>& columns,
-    const std::string& pkColumn,
-    const std::vector<std::string>& pkValues,
-    const std::vector<std::vector<std::string>>& batchData) {
+int TableSyncer::RunHashPipeline(
+    const TableInfo& tableInfo,
+    SQLHSTMT stmt,
+    const std::vector<int>& keyIndexes,
+    int maxRows,
+    bool& markSeen,
+    bool checkpoint,
+    std::string& lastKey,
+    int& rowsRead,
+    std::vector<std::string>* keysRead) {
     
-    if (pkValues.empty() || batchData.empty()) {
-        return;
-    }
+    const std::string& tableName = tableInfo.tableName;
+    const std::vector<std::string>& columns = tableInfo.columns;
     
-    try {
-        // Delete existing rows
-        if (!sqliteHelper.DeleteRows(tableName, pkColumn, pkValues)) {
-            logger->Error("Error deleting existing rows for hash-based sync");
-            return;
-        }
+    // Fetched batches are hashed on the worker pool while the next batch is read;
+    // they are diffed and written strictly in fetch order
+    auto tableStart = std::chrono::steady_clock::now();
+    size_t maxInFlight = hashPool ? static_cast<size_t>(hashPool->GetThreadCount()) : 0;
+    HashStageStats stats = {0.0, 0.0, 0.0};
+    std::deque<PendingHashBatch> inFlight;
+    
+    sqliteHelper.BeginTransaction();
+    
+    int rowsSynced = 0;
+    int rowsApplied = rowsRead;
+    PendingHashBatch current;
+    current.fetchStart = std::chrono::steady_clock::now();
+    
+    while ((maxRows <= 0 || rowsRead < maxRows) && odbcHelper.FetchRow(stmt)) {
+        std::vector<std::string> rowData;
         
-        // Insert updated rows
-        std::string insertSql = "INSERT INTO " + tableName + " (";
         for (size_t i = 0; i < columns.size(); ++i) {
-            insertSql += "\"" + columns[i] + "\"";
+            std::string value = odbcHelper.GetColumnData(stmt, i + 1);
+            rowData.push_back(value);
+        }
+        
+        std::string pkValue = KeyCodec::Extract(rowData, keyIndexes);
+        rowsRead++;
+        
+        if (!pkValue.empty()) {
+            lastKey = pkValue;
+            if (keysRead) {
+                keysRead->push_back(pkValue);
+            }
+            current.pkValues.push_back(pkValue);
+            current.batchData->push_back(std::move(rowData));
+        }
+        
+        if (current.batchData->size() >= static_cast<size_t>(batchSize)) {
+            current.hashes = SubmitHashBatch(current.batchData);
+            inFlight.push_back(std::move(current));
+            
+            while (inFlight.size() > maxInFlight) {
+                rowsApplied += static_cast<int>(inFlight.front().batchData->size());
+                rowsSynced += ApplyHashBatch(tableInfo, inFlight.front(), stats, markSeen, checkpoint, rowsApplied);
+                inFlight.pop_front();
+            }
+            
+            current = PendingHashBatch();
+            current.fetchStart = std::chrono::steady_clock::now();
+            TuneBatchSize();
+        }
+    }
+    
+    if (!current.batchData->empty()) {
+        current.hashes = SubmitHashBatch(current.batchData);
+        inFlight.push_back(std::move(current));
+    }
+    
+    while (!inFlight.empty()) {
+        rowsApplied += static_cast<int>(inFlight.front().batchData->size());
+        rowsSynced += ApplyHashBatch(tableInfo, inFlight.front(), stats, markSeen, checkpoint, rowsApplied);
+        inFlight.pop_front();
+    }
+    
+    sqliteHelper.CommitTransaction();
+    
+    double tableSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tableStart).count();
+    float hashPct = (stats.batchSeconds > 0) ? static_cast<float>(stats.hashSeconds / stats.batchSeconds * 100) : 0;
+    float waitPct = (tableSeconds > 0) ? static_cast<float>(stats.waitSeconds / tableSeconds * 100) : 0;
+    logger->Info("Hash stage for " + tableName + ": " + std::to_string(stats.hashSeconds) + "s hashing " + 
+                (hashPool ? "on " + std::to_string(maxInFlight) + " worker(s)" : std::string("inline")) + " (" + std::to_string(hashPct) + "% of batch time), " + 
+                std::to_string(stats.waitSeconds) + "s waiting for hashes (" + std::to_string(waitPct) + "% of " + 
+                std::to_string(tableSeconds) + "s)");
+    
+    return rowsSynced;
+}
+
+int TableSyncer::SyncRollingHash(const TableInfo& tableInfo) {
+    const std::string& tableName = tableInfo.tableName;
+    
+    auto lastSync = syncState->GetLastSync(tableName);
+    
+    if (lastSync.lastKeyValue.empty()) {
+        logger->Warning("No last key value for " + tableName + ", running a full hash-based pass first");
+        return SyncHashBased(tableInfo);
+    }
+    
+    // New keys beyond the watermark are picked up as in key-based sync
+    int rowsSynced = SyncKeyBased(tableInfo);
+    
+    int sliceRows = GetVerifySliceRows(tableName, lastSync.rowCount);
+    std::string cursor = lastSync.verifyCursor;
+    
+    try {
+        // Verify the next slice of keys that were already mirrored before this run
+        std::string selectSql = "SELECT " + SelectList(tableInfo);
+        std::string slice = KeyPredicate(tableInfo, "<=");
+        if (!cursor.empty()) {
+            slice = KeyPredicate(tableInfo, ">") + " AND " + slice;
+        }
+        selectSql += " FROM PUB." + tableName + SourceWhere(tableInfo, slice) + " ORDER BY " + KeyColumnList(tableInfo);
+        
+        SQLHSTMT stmt = odbcHelper.PrepareStatement(selectSql);
+        if (stmt == SQL_NULL_HSTMT) {
+            return rowsSynced;
+        }
+        
+        int paramIndex = 1;
+        std::deque<OdbcParam> keyParams;
+        if (!cursor.empty() && !BindKeyPredicate(stmt, paramIndex, tableInfo, cursor, keyParams)) {
+            odbcHelper.FreeStatement(stmt);
+            return rowsSynced;
+        }
+        
+        if (!BindKeyPredicate(stmt, paramIndex, tableInfo, lastSync.lastKeyValue, keyParams) ||
+            !odbcHelper.ExecutePreparedStatement(stmt)) {
+            odbcHelper.FreeStatement(stmt);
+            return rowsSynced;
+        }
+        
+        std::string lastKey;
+        int rowsRead = 0;
+        bool markSeen = false;
+        int rowsChanged = RunHashPipeline(tableInfo, stmt, GetKeyIndexes(tableInfo), sliceRows, markSeen, false, lastKey, rowsRead);
+        
+        bool sliceFailed = odbcHelper.LastFetchFailed();
+        odbcHelper.FreeStatement(stmt);
+        
+        // A short slice means the end of the verified range was reached; wrap to the first key
+        std::string nextCursor = cursor;
+        if (!sliceFailed) {
+            nextCursor = (rowsRead < sliceRows) ? "" : lastKey;
+        }
+        
+        logger->Info("Verified " + std::to_string(rowsRead) + " rows of " + tableName + " after key '" + 
+                    cursor + "', found " + std::to_string(rowsChanged) + " changes" + 
+                    (nextCursor.empty() && !sliceFailed ? " (verification pass complete)" : ""));
+        
+        auto current = syncState->GetLastSync(tableName);
+        syncState->UpdateSyncState(tableName, current.lastKeyValue, "rolling_hash", current.rowCount);
+        syncState->SetVerifyCursor(tableName, nextCursor);
+        
+        return rowsSynced + rowsChanged;
+    } catch (const std::exception& e) {
+        logger->Error("Error performing rolling hash verification of " + tableName + ": " + e.what());
+        sqliteHelper.RollbackTransaction();
+        return rowsSynced;
+    }
+}
+
+bool TableSyncer::UseRollingVerification(const std::string& tableName, int rowCount) {
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end() && (it->second.verifySlices > 0 || it->second.verifySliceRows > 0)) {
+        return true;
+    }
+    
+    return config.mirrorSettings.rollingHashMinRows > 0 && rowCount >= config.mirrorSettings.rollingHashMinRows;
+}
+
+int TableSyncer::GetVerifySliceRows(const std::string& tableName, int rowCount) {
+    int slices = config.mirrorSettings.verifySlices;
+    
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end()) {
+        if (it->second.verifySliceRows > 0) {
+            return it->second.verifySliceRows;
+        }
+        if (it->second.verifySlices > 0) {
+            slices = it->second.verifySlices;
+        }
+    }
+    
+    if (slices <= 0) {
+        slices = 1;
+    }
+    
+    int sliceRows = (rowCount + slices - 1) / slices;
+    return std::max(sliceRows, batchSize);
+}
+
+int TableSyncer::SyncHashFingerprinted(const TableInfo& tableInfo, const std::string& modColumn, int bucketRows) {
+    const std::string& tableName = tableInfo.tableName;
+    std::vector<int> keyIndexes = GetKeyIndexes(tableInfo);
+    
+    try {
+        auto ranges = hashDb->GetFingerprints(tableName);
+        bool initialPass = ranges.empty();
+        
+        // Keys past a broken scan were never bucketed, so the first pass only stores ranges once it sees them all
+        bool complete = DiscoverKeyRanges(tableInfo, bucketRows, ranges);
+        if (!complete && initialPass) {
+            ranges.clear();
+        }
+        
+        int rowsSynced = 0;
+        int rowsDeleted = 0;
+        int rangesFetched = 0;
+        int totalRows = 0;
+        
+        for (auto& range : ranges) {
+            // Taken before the rows are read, so a change racing the fetch moves it again next run
+            std::string fingerprint = QueryRangeFingerprint(tableInfo, modColumn, range);
+            if (fingerprint.empty()) {
+                complete = false;
+                break;
+            }
+            
+            totalRows += FingerprintRowCount(fingerprint);
+            if (fingerprint == range.fingerprint) {
+                continue;
+            }
+            
+            rangesFetched++;
+            int rangeDeleted = 0;
+            if (!SyncKeyRange(tableInfo, keyIndexes, range, rowsSynced, rangeDeleted)) {
+                complete = false;
+                break;
+            }
+            rowsDeleted += rangeDeleted;
+            
+            // Stored only once the range is mirrored; an interrupted range is fetched again
+            range.fingerprint = fingerprint;
+            hashDb->StoreFingerprint(tableName, range);
+        }
+        
+        // The first complete pass assigned every source key to a range; anything left over is gone
+        if (initialPass && complete) {
+            rowsDeleted += ApplyHashDeletes(tableInfo, hashDb->GetBucketKeys(tableName, 0));
+        }
+        
+        logger->Info("Completed fingerprint sync of " + tableName + ": " + 
+                    std::to_string(rangesFetched) + " of " + std::to_string(ranges.size()) + " key ranges fetched, " + 
+                    std::to_string(rowsSynced) + " changed rows, " + std::to_string(rowsDeleted) + " deleted rows");
+        
+        auto lastSync = syncState->GetLastSync(tableName);
+        if (complete && !ranges.empty()) {
+            syncState->UpdateSyncState(tableName, ranges.back().highKey, "hash_based", totalRows);
+        } else {
+            logger->Warning("Fingerprint sync of " + tableName + " did not complete, remaining ranges are checked next run");
+            syncState->UpdateSyncState(tableName, lastSync.lastKeyValue, "hash_based", 
+                                       std::max(0, lastSync.rowCount - rowsDeleted));
+        }
+        
+        return rowsSynced + rowsDeleted;
+    } catch (const std::exception& e) {
+        logger->Error("Error performing fingerprint sync of " + tableName + ": " + e.what());
+        sqliteHelper.RollbackTransaction();
+        return 0;
+    }
+}
+
+std::string TableSyncer::GetIsolationLevel(const std::string& tableName) {
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end() && !it->second.isolationLevel.empty()) {
+        return it->second.isolationLevel;
+    }
+    
+    return config.progressDb.isolationLevel;
+}
+
+int TableSyncer::GetTableBatchSize(const std::string& tableName) {
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end() && it->second.batchSize > 0) {
+        return it->second.batchSize;
+    }
+    
+    return 0;
+}
+
+int TableSyncer::GetFingerprintBucketRows(const std::string& tableName) {
+    auto it = config.tables.find(tableName);
+    if (it != config.tables.end() && it->second.fingerprintBucketRows >= 0) {
+        return it->second.fingerprintBucketRows;
+    }
+    
+    return config.mirrorSettings.fingerprintBucketRows;
+}
+
+bool TableSyncer::DiscoverKeyRanges(
+    const TableInfo& tableInfo,
+    int bucketRows,
+    std::vector<HashStorage::RangeFingerprint>& ranges) {
+    
+    const std::string& tableName = tableInfo.tableName;
+    std::string keyColumns = KeyColumnList(tableInfo);
+    
+    // Only keys beyond the last known range are read, and only the key columns
+    std::string selectSql = "SELECT " + keyColumns + " FROM PUB." + tableName + 
+                            SourceWhere(tableInfo, ranges.empty() ? "" : KeyPredicate(tableInfo, ">"));
+    selectSql += " ORDER BY " + keyColumns;
+    
+    SQLHSTMT stmt = odbcHelper.PrepareStatement(selectSql);
+    if (stmt == SQL_NULL_HSTMT) {
+        return false;
+    }
+    
+    int paramIndex = 1;
+    std::deque<OdbcParam> afterKey;
+    if ((!ranges.empty() && !BindKeyPredicate(stmt, paramIndex, tableInfo, ranges.back().highKey, afterKey)) ||
+        !odbcHelper.ExecutePreparedStatement(stmt)) {
+        odbcHelper.FreeStatement(stmt);
+        return false;
+    }
+    
+    // A short last range is widened first so appends do not leave a trail of tiny ranges
+    int room = 0;
+    if (!ranges.empty() && !ranges.back().fingerprint.empty()) {
+        room = std::max(0, bucketRows - FingerprintRowCount(ranges.back().fingerprint));
+    }
+    
+    int nextId = ranges.empty() ? 1 : ranges.back().bucketId + 1;
+    int rangeRows = bucketRows;
+    int keysFound = 0;
+    
+    std::vector<int> keyIndexes;
+    for (size_t i = 0; i < tableInfo.pkColumns.size(); ++i) {
+        keyIndexes.push_back(static_cast<int>(i));
+    }
+    
+    while (odbcHelper.FetchRow(stmt)) {
+        std::vector<std::string> keyData;
+        for (size_t i = 0; i < keyIndexes.size(); ++i) {
+            keyData.push_back(odbcHelper.GetColumnData(stmt, i + 1));
+        }
+        
+        std::string key = KeyCodec::Extract(keyData, keyIndexes);
+        if (key.empty()) {
+            continue;
+        }
+        keysFound++;
+        
+        if (room > 0) {
+            ranges.back().highKey = key;
+            ranges.back().fingerprint = "";
+            room--;
+        } else if (rangeRows >= bucketRows) {
+            HashStorage::RangeFingerprint range;
+            range.bucketId = nextId++;
+            range.hasLowKey = !ranges.empty();
+            range.lowKey = ranges.empty() ? "" : ranges.back().highKey;
+            range.highKey = key;
+            ranges.push_back(range);
+            rangeRows = 1;
+        } else {
+            ranges.back().highKey = key;
+            rangeRows++;
+        }
+    }
+    
+    bool scanComplete = !odbcHelper.LastFetchFailed();
+    odbcHelper.FreeStatement(stmt);
+    
+    if (keysFound > 0) {
+        logger->Info("Found " + std::to_string(keysFound) + " keys beyond the known ranges of " + tableName + 
+                    ", now " + std::to_string(ranges.size()) + " key ranges");
+    }
+    
+    if (!scanComplete) {
+        logger->Warning("Key scan of " + tableName + " stopped early; its remaining keys are bucketed next run");
+    }
+    return scanComplete;
+}
+
+std::string TableSyncer::QueryRangeFingerprint(
+    const TableInfo& tableInfo,
+    const std::string& modColumn,
+    const HashStorage::RangeFingerprint& range) {
+    
+    const std::vector<std::string>& pkColumns = tableInfo.pkColumns;
+    
+    // One MAX per key column; a single-column key keeps the COUNT|MAX(key)|MAX(mod) layout
+    std::string selectSql = "SELECT COUNT(*), ";
+    for (const auto& pkColumn : pkColumns) {
+        selectSql += "MAX(" + SourceColumn(tableInfo, pkColumn) + "), ";
+    }
+    selectSql += "MAX(\"" + modColumn + "\") FROM PUB." + tableInfo.tableName;
+    
+    SQLHSTMT stmt = ExecuteRangeQuery(selectSql, tableInfo, range, "");
+    if (stmt == SQL_NULL_HSTMT) {
+        return "";
+    }
+    
+    std::string fingerprint;
+    if (odbcHelper.FetchRow(stmt)) {
+        fingerprint = odbcHelper.GetColumnData(stmt, 1);
+        for (size_t i = 0; i <= pkColumns.size(); ++i) {
+            fingerprint += "|" + odbcHelper.GetColumnData(stmt, static_cast<int>(i) + 2);
+        }
+    }
+    
+    odbcHelper.FreeStatement(stmt);
+    return fingerprint;
+}
+
+bool TableSyncer::SyncKeyRange(
+    const TableInfo& tableInfo,
+    const std::vector<int>& keyIndexes,
+    const HashStorage::RangeFingerprint& range,
+    int& rowsSynced,
+    int& rowsDeleted) {
+    
+    const std::string& tableName = tableInfo.tableName;
+    
+    std::string selectSql = "SELECT " + SelectList(tableInfo);
+    selectSql += " FROM PUB." + tableName;
+    
+    SQLHSTMT stmt = ExecuteRangeQuery(selectSql, tableInfo, range, " ORDER BY " + KeyColumnList(tableInfo));
+    if (stmt == SQL_NULL_HSTMT) {
+        return false;
+    }
+    
+    std::vector<std::string> keysRead;
+    std::string lastKey;
+    int rowsRead = 0;
+    bool markSeen = false;
+    rowsSynced += RunHashPipeline(tableInfo, stmt, keyIndexes, 0, markSeen, false, lastKey, rowsRead, &keysRead);
+    
+    bool fetchFailed = odbcHelper.LastFetchFailed();
+    odbcHelper.FreeStatement(stmt);
+    
+    if (fetchFailed) {
+        return false;
+    }
+    
+    // Keys that belonged to this range last time but were not read now were deleted
+    std::set<std::string> present(keysRead.begin(), keysRead.end());
+    std::vector<std::string> deletedKeys;
+    for (const auto& key : hashDb->GetBucketKeys(tableName, range.bucketId)) {
+        if (present.find(key) == present.end()) {
+            deletedKeys.push_back(key);
+        }
+    }
+    
+    rowsDeleted = ApplyHashDeletes(tableInfo, deletedKeys);
+    return hashDb->AssignBucket(tableName, range.bucketId, keysRead);
+}
+
+SQLHSTMT TableSyncer::ExecuteRangeQuery(
+    const std::string& selectSql,
+    const TableInfo& tableInfo,
+    const HashStorage::RangeFingerprint& range,
+    const std::string& suffix) {
+    
+    std::string predicate = KeyPredicate(tableInfo, "<=");
+    if (range.hasLowKey) {
+        predicate = KeyPredicate(tableInfo, ">") + " AND " + predicate;
+    }
+    std::string rangeSql = selectSql + SourceWhere(tableInfo, predicate) + suffix;
+    
+    SQLHSTMT stmt = odbcHelper.PrepareStatement(rangeSql);
+    if (stmt == SQL_NULL_HSTMT) {
+        return SQL_NULL_HSTMT;
+    }
+    
+    int paramIndex = 1;
+    std::deque<OdbcParam> keyParams;
+    if ((range.hasLowKey && !BindKeyPredicate(stmt, paramIndex, tableInfo, range.lowKey, keyParams)) ||
+        !BindKeyPredicate(stmt, paramIndex, tableInfo, range.highKey, keyParams) ||
+        !odbcHelper.ExecutePreparedStatement(stmt)) {
+        odbcHelper.FreeStatement(stmt);
+        return SQL_NULL_HSTMT;
+    }
+    
+    return stmt;
+}
+
+int TableSyncer::FingerprintRowCount(const std::string& fingerprint) {
+    try {
+        return std::stoi(fingerprint.substr(0, fingerprint.find('|')));
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+int TableSyncer::SyncMultiset(const TableInfo& tableInfo) {
+    const std::string& tableName = tableInfo.tableName;
+    
+    try {
+        // One entry per distinct mirrored row; duplicates are carried by the count
+        std::unordered_map<std::string, int> remaining;
+        int untagged = 0;
+        if (!LoadMirrorDigests(tableInfo, remaining, untagged)) {
+            return 0;
+        }
+        
+        // Rows mirrored before they were tagged cannot be matched, so they are reloaded once
+        if (untagged > 0) {
+            logger->Warning(std::to_string(untagged) + " rows of " + tableName + 
+                           " have no row digest, falling back to full sync");
+            return SyncFullTable(tableInfo);
+        }
+        
+        std::string selectSql = "SELECT " + SelectList(tableInfo) + " FROM PUB." + tableName + SourceWhere(tableInfo, "");
+        SQLHSTMT stmt = odbcHelper.ExecuteQuery(selectSql);
+        if (stmt == SQL_NULL_HSTMT) {
+            return 0;
+        }
+        
+        sqlite3_stmt* insertStmt = sqliteHelper.PrepareStatement(BuildInsertSql(tableInfo));
+        if (!insertStmt) {
+            odbcHelper.FreeStatement(stmt);
+            return 0;
+        }
+        
+        // Batches are hashed on the pool while the next one is fetched, then matched in fetch order
+        size_t maxInFlight = hashPool ? static_cast<size_t>(hashPool->GetThreadCount()) : 0;
+        std::deque<PendingHashBatch> inFlight;
+        PendingHashBatch current;
+        int rowsRead = 0;
+        int rowsInserted = 0;
+        
+        sqliteHelper.BeginTransaction();
+        
+        while (odbcHelper.FetchRow(stmt)) {
+            std::vector<std::string> rowData;
+            for (size_t i = 0; i < tableInfo.columns.size(); ++i) {
+                rowData.push_back(odbcHelper.GetColumnData(stmt, i + 1));
+            }
+            current.batchData->push_back(std::move(rowData));
+            rowsRead++;
+            
+            if (current.batchData->size() >= static_cast<size_t>(batchSize)) {
+                current.hashes = SubmitHashBatch(current.batchData, false);
+                inFlight.push_back(std::move(current));
+                
+                while (inFlight.size() > maxInFlight) {
+                    rowsInserted += ApplyMultisetBatch(tableInfo, inFlight.front(), remaining, insertStmt);
+                    inFlight.pop_front();
+                }
+                
+                current = PendingHashBatch();
+                TuneBatchSize();
+            }
+        }
+        
+        if (!current.batchData->empty()) {
+            current.hashes = SubmitHashBatch(current.batchData, false);
+            inFlight.push_back(std::move(current));
+        }
+        
+        while (!inFlight.empty()) {
+            rowsInserted += ApplyMultisetBatch(tableInfo, inFlight.front(), remaining, insertStmt);
+            inFlight.pop_front();
+        }
+        
+        sqlite3_finalize(insertStmt);
+        sqliteHelper.CommitTransaction();
+        
+        // Unmatched mirror rows only prove a delete once every source row has been seen
+        bool scanComplete = !odbcHelper.LastFetchFailed();
+        odbcHelper.FreeStatement(stmt);
+        
+        int rowsDeleted = 0;
+        if (scanComplete) {
+            rowsDeleted = DeleteMultisetRows(tableInfo, remaining);
+        } else {
+            logger->Warning("Source scan of " + tableName + " did not complete, skipping delete detection");
+        }
+        
+        runStats.rowsInserted += rowsInserted;
+        runStats.rowsDeleted += rowsDeleted;
+        
+        logger->Info("Completed multiset sync of " + tableName + ": " + std::to_string(rowsRead) + 
+                    " rows read, " + std::to_string(rowsInserted) + " inserted, " + 
+                    std::to_string(rowsDeleted) + " deleted");
+        
+        auto lastSync = syncState->GetLastSync(tableName);
+        int totalRows = scanComplete ? rowsRead : lastSync.rowCount + rowsInserted;
+        syncState->UpdateSyncState(tableName, "", "multiset", totalRows);
+        
+        return rowsInserted + rowsDeleted;
+    } catch (const std::exception& e) {
+        logger->Error("Error performing multiset sync of " + tableName + ": " + e.what());
+        sqliteHelper.RollbackTransaction();
+        return 0;
+    }
+}
+
+int TableSyncer::SyncCdc(const TableInfo& tableInfo) {
+    const std::string& tableName = tableInfo.tableName;
+    const std::string& sequenceColumn = config.mirrorSettings.cdcSequenceColumn;
+    const std::string& operationColumn = config.mirrorSettings.cdcOperationColumn;
+    bool refetch = config.mirrorSettings.cdcRefetchRows;
+    
+    // Changes only apply on top of a mirror loaded at a known sequence
+    auto lastSync = syncState->GetLastSync(tableName);
+    if (lastSync.cdcSequence < 0) {
+        logger->Info("No CDC sequence recorded for " + tableName + ", reloading it before consuming changes");
+        return SyncFullTable(tableInfo);
+    }
+    
+    try {
+        // In refetch mode the change table only names the keys; rows come from the source
+        std::string selectSql = "SELECT \"" + sequenceColumn + "\", \"" + operationColumn + "\", " + 
+                                (refetch ? KeyColumnList(tableInfo) : SelectList(tableInfo)) + 
+                                " FROM " + tableInfo.cdcTable + 
+                                " WHERE \"" + sequenceColumn + "\" > ? ORDER BY \"" + sequenceColumn + "\"";
+        
+        SQLHSTMT stmt = odbcHelper.PrepareStatement(selectSql);
+        if (stmt == SQL_NULL_HSTMT) {
+            return 0;
+        }
+        
+        OdbcParam sequenceParam;
+        if (!odbcHelper.BindTypedParameter(stmt, 1, SQL_BIGINT, std::to_string(lastSync.cdcSequence), sequenceParam) ||
+            !odbcHelper.ExecutePreparedStatement(stmt)) {
+            odbcHelper.FreeStatement(stmt);
+            return 0;
+        }
+        
+        size_t changeColumns = refetch ? tableInfo.pkColumns.size() : tableInfo.columns.size();
+        std::vector<int> keyIndexes;
+        if (refetch) {
+            for (size_t i = 0; i < changeColumns; ++i) {
+                keyIndexes.push_back(static_cast<int>(i));
+            }
+        } else {
+            keyIndexes = GetKeyIndexes(tableInfo);
+        }
+        
+        std::map<std::string, CdcChange> changes;
+        long long sequence = lastSync.cdcSequence;
+        int changesRead = 0;
+        int batchChanges = 0;
+        int rowsSynced = 0;
+        int rowDelta = 0;
+        
+        sqliteHelper.BeginTransaction();
+        
+        while (odbcHelper.FetchRow(stmt)) {
+            std::string sequenceValue = odbcHelper.GetColumnData(stmt, 1);
+            int operation = std::atoi(odbcHelper.GetColumnData(stmt, 2).c_str());
+            
+            std::vector<std::string> rowData;
+            for (size_t i = 0; i < changeColumns; ++i) {
+                rowData.push_back(odbcHelper.GetColumnData(stmt, i + 3));
+            }
+            
+            sequence = std::strtoll(sequenceValue.c_str(), nullptr, 10);
+            changesRead++;
+            batchChanges++;
+            
+            // Before-images carry nothing the after-image does not
+            if (operation == CDC_CREATE || operation == CDC_UPDATE_AFTER || operation == CDC_DELETE) {
+                std::string pkValue = KeyCodec::Extract(rowData, keyIndexes);
+                if (pkValue.empty()) {
+                    logger->Warning("CDC change " + sequenceValue + " for " + tableName + " has no key, skipping it");
+                } else {
+                    changes[pkValue] = CdcChange{operation, rowData};
+                }
+                
+                if (operation == CDC_CREATE) {
+                    runStats.rowsInserted++;
+                    rowDelta++;
+                } else if (operation == CDC_DELETE) {
+                    runStats.rowsDeleted++;
+                    rowDelta--;
+                } else {
+                    runStats.rowsUpdated++;
+                }
+            } else if (operation != CDC_UPDATE_BEFORE) {
+                logger->Warning("Unknown CDC operation " + std::to_string(operation) + " at sequence " + 
+                               sequenceValue + " for " + tableName);
+            }
+            
+            // The watermark commits with the batch it covers
+            if (batchChanges >= batchSize) {
+                int written = ApplyCdcBatch(tableInfo, changes);
+                if (written < 0) {
+                    odbcHelper.FreeStatement(stmt);
+                    sqliteHelper.RollbackTransaction();
+                    return 0;
+                }
+                rowsSynced += written;
+                changes.clear();
+                syncState->SetCdcSequence(tableName, sequence);
+                sqliteHelper.CommitTransaction();
+                sqliteHelper.BeginTransaction();
+                
+                logger->Info("Applied " + std::to_string(changesRead) + " CDC changes to " + tableName + 
+                            " (through sequence " + std::to_string(sequence) + ")");
+                batchChanges = 0;
+                TuneBatchSize();
+            }
+        }
+        
+        if (!changes.empty()) {
+            int written = ApplyCdcBatch(tableInfo, changes);
+            if (written < 0) {
+                odbcHelper.FreeStatement(stmt);
+                sqliteHelper.RollbackTransaction();
+                return 0;
+            }
+            rowsSynced += written;
+        }
+        
+        bool scanComplete = !odbcHelper.LastFetchFailed();
+        odbcHelper.FreeStatement(stmt);
+        
+        syncState->SetCdcSequence(tableName, sequence);
+        if (scanComplete) {
+            syncState->UpdateSyncState(tableName, lastSync.lastKeyValue, "cdc", std::max(0, lastSync.rowCount + rowDelta));
+        } else {
+            logger->Warning("CDC read for " + tableName + " stopped at sequence " + std::to_string(sequence) + 
+                           "; the next run continues from there");
+        }
+        sqliteHelper.CommitTransaction();
+        
+        logger->Info("Completed CDC sync of " + tableName + ": " + std::to_string(changesRead) + 
+                    " changes read, " + std::to_string(rowsSynced) + " rows written, now at sequence " + 
+                    std::to_string(sequence));
+        return rowsSynced;
+    } catch (const std::exception& e) {
+        logger->Error("Error performing CDC sync of " + tableName + ": " + e.what());
+        sqliteHelper.RollbackTransaction();
+        return 0;
+    }
+}
+
+bool TableSyncer::QueryCdcHighWater(const TableInfo& tableInfo, long long& sequence) {
+    std::string sql = "SELECT MAX(\"" + config.mirrorSettings.cdcSequenceColumn + "\") FROM " + tableInfo.cdcTable;
+    SQLHSTMT stmt = odbcHelper.ExecuteQuery(sql);
+    if (stmt == SQL_NULL_HSTMT) {
+        logger->Error("Could not read the CDC sequence of " + tableInfo.cdcTable);
+        return false;
+    }
+    
+    // An empty change table has no sequence yet; everything after 0 is new
+    sequence = 0;
+    if (odbcHelper.FetchRow(stmt)) {
+        std::string value = odbcHelper.GetColumnData(stmt, 1);
+        if (!value.empty()) {
+            sequence = std::strtoll(value.c_str(), nullptr, 10);
+        }
+    }
+    
+    odbcHelper.FreeStatement(stmt);
+    return true;
+}
+
+int TableSyncer::ApplyCdcBatch(const TableInfo& tableInfo, const std::map<std::string, CdcChange>& changes) {
+    const std::string& tableName = tableInfo.tableName;
+    std::vector<std::string> deletedKeys;
+    std::vector<std::string> upsertKeys;
+    std::vector<std::vector<std::string>> upsertRows;
+    
+    for (const auto& change : changes) {
+        if (change.second.operation == CDC_DELETE) {
+            deletedKeys.push_back(change.first);
+        } else {
+            upsertKeys.push_back(change.first);
+            upsertRows.push_back(change.second.rowData);
+        }
+    }
+    
+    int rowsWritten = 0;
+    
+    if (!deletedKeys.empty()) {
+        if (!DeleteKeyedRows(tableName, tableInfo.pkColumns, deletedKeys)) {
+            logger->Error("Error applying CDC deletes to " + tableName);
+        } else {
+            if (hashEnabled) {
+                hashDb->DeleteHashes(tableName, deletedKeys);
+            }
+            rowsWritten += static_cast<int>(deletedKeys.size());
+        }
+    }
+    
+    // Re-read the changed keys in bulk; a key the source no longer has was deleted
+    // after its change was logged
+    if (config.mirrorSettings.cdcRefetchRows && !upsertKeys.empty()) {
+        std::vector<std::string> fetchedKeys;
+        std::vector<std::vector<std::string>> fetchedRows;
+        if (!FetchRowsByKey(tableInfo, upsertKeys, fetchedKeys, fetchedRows)) {
+            return -1;
+        }
+        
+        std::set<std::string> found(fetchedKeys.begin(), fetchedKeys.end());
+        std::vector<std::string> goneKeys;
+        for (const auto& key : upsertKeys) {
+            if (found.count(key) == 0) {
+                goneKeys.push_back(key);
+            }
+        }
+        
+        if (!goneKeys.empty() && DeleteKeyedRows(tableName, tableInfo.pkColumns, goneKeys)) {
+            if (hashEnabled) {
+                hashDb->DeleteHashes(tableName, goneKeys);
+            }
+            rowsWritten += static_cast<int>(goneKeys.size());
+        }
+        
+        upsertKeys.swap(fetchedKeys);
+        upsertRows.swap(fetchedRows);
+    }
+    
+    // Creates and updates both replace the row with its latest image
+    if (!upsertKeys.empty()) {
+        ProcessKeyBasedBatch(tableName, tableInfo.columns, tableInfo.pkColumns, upsertKeys, upsertRows);
+        rowsWritten += static_cast<int>(upsertKeys.size());
+    }
+    
+    return rowsWritten;
+}
+
+bool TableSyncer::LoadOverlapRows(const TableInfo& tableInfo, const std::string& lowerBound,
+                                  std::unordered_map<std::string, int>& copies) {
+    const std::string& tableName = tableInfo.tableName;
+    const std::string& timestampColumn = tableInfo.plan.timestampColumn;
+    
+    // The mirror keeps the source's text, which orders like the timestamps it holds
+    std::string indexSql = "CREATE INDEX IF NOT EXISTS \"idx_" + tableName + "_" + timestampColumn + 
+                           "\" ON " + tableName + " (\"" + timestampColumn + "\")";
+    if (!sqliteHelper.ExecuteNonQuery(indexSql)) {
+        return false;
+    }
+    
+    std::string selectSql = "SELECT ";
+    for (size_t i = 0; i < tableInfo.columns.size(); ++i) {
+        selectSql += "\"" + tableInfo.columns[i] + "\"";
+        if (i < tableInfo.columns.size() - 1) {
+            selectSql += ", ";
+        }
+    }
+    selectSql += " FROM " + tableName + " WHERE \"" + timestampColumn + "\" >= ?";
+    
+    sqlite3_stmt* stmt = sqliteHelper.PrepareStatement(selectSql);
+    if (!stmt) {
+        return false;
+    }
+    
+    if (!sqliteHelper.BindParameter(stmt, 1, lowerBound)) {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    
+    int rc;
+    std::vector<std::string> rowData(tableInfo.columns.size());
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        // Empty source values are stored as NULL
+        for (size_t i = 0; i < rowData.size(); ++i) {
+            const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, static_cast<int>(i)));
+            rowData[i] = value ? value : "";
+        }
+        copies[KeyCodec::Encode(rowData)]++;
+    }
+    
+    if (rc != SQLITE_DONE) {
+        logger->Error("Error reading the overlap window of " + tableName + ": " + 
+                     std::string(sqlite3_errmsg(sqlite3_db_handle(stmt))));
+    }
+    
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool TableSyncer::LoadMirrorDigests(const TableInfo& tableInfo, std::unordered_map<std::string, int>& digests,
+                                    int& untagged) {
+    std::string digestSql = "SELECT \"" + tableInfo.digestColumn + "\", COUNT(*) FROM " + tableInfo.tableName + 
+                            " GROUP BY \"" + tableInfo.digestColumn + "\"";
+    
+    sqlite3_stmt* stmt = sqliteHelper.PrepareStatement(digestSql);
+    if (!stmt) {
+        return false;
+    }
+    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* digest = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (digest) {
+            digests[digest] = sqlite3_column_int(stmt, 1);
+        } else {
+            untagged = sqlite3_column_int(stmt, 1);
+        }
+    }
+    
+    if (rc != SQLITE_DONE) {
+        logger->Error("Error reading row digests of " + tableInfo.tableName + ": " + 
+                     std::string(sqlite3_errmsg(sqlite3_db_handle(stmt))));
+    }
+    
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+int TableSyncer::ApplyMultisetBatch(
+    const TableInfo& tableInfo,
+    PendingHashBatch& batch,
+    std::unordered_map<std::string, int>& remaining,
+    sqlite3_stmt* insertStmt) {
+    
+    HashBatchResult hashed = batch.hashes.get();
+    runStats.hashSeconds += hashed.hashSeconds;
+    int rowsInserted = 0;
+    
+    for (size_t i = 0; i < batch.batchData->size(); ++i) {
+        // Each source row consumes one mirrored copy of itself; a row with none left is new
+        auto it = remaining.find(hashed.rowHashes[i]);
+        if (it != remaining.end() && it->second > 0) {
+            it->second--;
+            continue;
+        }
+        
+        const auto& row = (*batch.batchData)[i];
+        sqlite3_reset(insertStmt);
+        
+        for (size_t col = 0; col < row.size(); ++col) {
+            sqliteHelper.BindParameter(insertStmt, col + 1, row[col]);
+        }
+        sqliteHelper.BindParameter(insertStmt, row.size() + 1, hashed.rowHashes[i]);
+        
+        if (sqlite3_step(insertStmt) != SQLITE_DONE) {
+            logger->Error("Error inserting row: " + std::string(sqlite3_errmsg(sqlite3_db_handle(insertStmt))));
+        } else {
+            rowsInserted++;
+        }
+    }
+    
+    sqliteHelper.CommitTransaction();
+    sqliteHelper.BeginTransaction();
+    
+    logger->Info("Processed " + std::to_string(batch.batchData->size()) + " rows for " + tableInfo.tableName + 
+                ", " + std::to_string(rowsInserted) + " new");
+    return rowsInserted;
+}
+
+int TableSyncer::DeleteMultisetRows(const TableInfo& tableInfo, const std::unordered_map<std::string, int>& remaining) {
+    const std::string& tableName = tableInfo.tableName;
+    
+    // Copies are interchangeable, so any `count` rows carrying the digest will do
+    std::string deleteSql = "DELETE FROM " + tableName + " WHERE rowid IN (SELECT rowid FROM " + tableName + 
+                            " WHERE \"" + tableInfo.digestColumn + "\" = ? LIMIT ?)";
+    
+    sqlite3_stmt* deleteStmt = sqliteHelper.PrepareStatement(deleteSql);
+    if (!deleteStmt) {
+        return 0;
+    }
+    
+    int rowsDeleted = 0;
+    int pending = 0;
+    sqliteHelper.BeginTransaction();
+    
+    for (const auto& entry : remaining) {
+        if (entry.second <= 0) {
+            continue;
+        }
+        
+        sqlite3_reset(deleteStmt);
+        sqliteHelper.BindParameter(deleteStmt, 1, entry.first);
+        sqlite3_bind_int(deleteStmt, 2, entry.second);
+        
+        if (sqlite3_step(deleteStmt) != SQLITE_DONE) {
+            logger->Error("Error deleting removed rows from " + tableName + ": " + 
+                         std::string(sqlite3_errmsg(sqlite3_db_handle(deleteStmt))));
+            continue;
+        }
+        
+        rowsDeleted += sqlite3_changes(sqlite3_db_handle(deleteStmt));
+        pending += entry.second;
+        if (pending >= batchSize) {
+            sqliteHelper.CommitTransaction();
+            sqliteHelper.BeginTransaction();
+            pending = 0;
+        }
+    }
+    
+    sqliteHelper.CommitTransaction();
+    sqlite3_finalize(deleteStmt);
+    
+    if (rowsDeleted > 0) {
+        logger->Info("Deleted " + std::to_string(rowsDeleted) + " rows no longer in source table " + tableName);
+    }
+    
+    return rowsDeleted;
+}
+
+std::string TableSyncer::BuildInsertSql(const TableInfo& tableInfo) {
+    std::vector<std::string> columns = tableInfo.columns;
+    if (!tableInfo.digestColumn.empty()) {
+        columns.push_back(tableInfo.digestColumn);
+    }
+    
+    std::string insertSql = "INSERT INTO " + tableInfo.tableName + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        insertSql += "\"" + columns[i] + "\"";
+        if (i < columns.size() - 1) {
+            insertSql += ", ";
+        }
+    }
+    insertSql += ") VALUES (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        insertSql += "?";
+        if (i < columns.size() - 1) {
+            insertSql += ", ";
+        }
+    }
+    insertSql += ")";
+    
+    return insertSql;
+}
+
+std::future<HashBatchResult> TableSyncer::SubmitHashBatch(
+    std::shared_ptr<const std::vector<std::vector<std::string>>> batchData, bool columnHashes) {
+    int columnGroupSize = columnHashes ? hashDb->GetColumnGroupSize() : 0;
+    
+    if (hashPool) {
+        return hashPool->Submit(std::move(batchData), columnGroupSize);
+    }
+    
+    // No pool configured: hash inline and hand back an already-satisfied future
+    auto start = std::chrono::steady_clock::now();
+    HashBatchResult result;
+    for (const auto& row : *batchData) {
+        result.rowHashes.push_back(HashCalculator::CalculateRowHash(row));
+        if (columnGroupSize > 0) {
+            result.columnHashes.push_back(HashCalculator::CalculateColumnHashes(row, columnGroupSize));
+        }
+    }
+    result.hashSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::promise<HashBatchResult> ready;
+    ready.set_value(std::move(result));
+    return ready.get_future();
+}
+
+int TableSyncer::ApplyHashBatch(
+    const TableInfo& tableInfo,
+    PendingHashBatch& batch,
+    HashStageStats& stats,
+    bool& markSeen,
+    bool checkpoint,
+    int rowsThrough) {
+    
+    const std::string& tableName = tableInfo.tableName;
+    const std::vector<std::string>& columns = tableInfo.columns;
+    
+    auto waitStart = std::chrono::steady_clock::now();
+    HashBatchResult hashed = batch.hashes.get();
+    auto waitEnd = std::chrono::steady_clock::now();
+    
+    // Keys that could not be marked would look deleted, so the rest of the run stops tracking
+    if (markSeen && !hashDb->MarkSeen(batch.pkValues)) {
+        logger->Warning("Could not record the keys read from " + tableName + ", delete detection disabled for this run");
+        markSeen = false;
+    }
+    
+    // Rows to delete and re-insert whole, and rows where only some column groups changed
+    std::vector<size_t> rewriteRows;
+    std::vector<ColumnUpdate> columnUpdates;
+    int columnGroupSize = hashDb->GetColumnGroupSize();
+    int newRowCount = 0;
+    
+    if (columnGroupSize > 0) {
+        for (size_t i = 0; i < batch.pkValues.size(); ++i) {
+            auto stored = hashDb->GetStoredHash(tableName, batch.pkValues[i]);
+            
+            if (!stored.rowHash.empty() && stored.rowHash == hashed.rowHashes[i]) {
+                continue;
+            }
+            
+            auto storedDigests = HashCalculator::SplitColumnHashes(stored.columnHashes);
+            auto currentDigests = HashCalculator::SplitColumnHashes(hashed.columnHashes[i]);
+            
+            // New rows and rows hashed under a different column layout are rewritten whole
+            if (stored.rowHash.empty() || storedDigests.size() != currentDigests.size()) {
+                if (stored.rowHash.empty()) {
+                    newRowCount++;
+                }
+                rewriteRows.push_back(i);
+                continue;
+            }
+            
+            ColumnUpdate update;
+            update.rowIndex = i;
+            for (size_t group = 0; group < currentDigests.size(); ++group) {
+                if (storedDigests[group] != currentDigests[group]) {
+                    size_t end = std::min(columns.size(), (group + 1) * static_cast<size_t>(columnGroupSize));
+                    for (size_t col = group * columnGroupSize; col < end; ++col) {
+                        update.columnIndexes.push_back(col);
+                    }
+                }
+            }
+            
+            if (update.columnIndexes.empty()) {
+                rewriteRows.push_back(i);
+            } else {
+                columnUpdates.push_back(update);
+            }
+        }
+    } else {
+        std::vector<std::string> newRows;
+        auto changedRows = hashDb->GetChangedRows(tableName, batch.pkValues, hashed.rowHashes, &newRows);
+        newRowCount = static_cast<int>(newRows.size());
+        std::set<std::string> changedSet(changedRows.begin(), changedRows.end());
+        
+        for (size_t i = 0; i < batch.pkValues.size(); ++i) {
+            if (changedSet.count(batch.pkValues[i])) {
+                rewriteRows.push_back(i);
+            }
+        }
+    }
+    
+    size_t changedCount = rewriteRows.size() + columnUpdates.size();
+    runStats.rowsInserted += newRowCount;
+    runStats.rowsUpdated += static_cast<int>(changedCount) - newRowCount;
+    
+    if (!columnUpdates.empty()) {
+        // Rows missing from the mirror come back from here and are inserted instead
+        auto missingRows = ProcessColumnUpdates(tableInfo, batch.pkValues, *batch.batchData, hashed, columnUpdates);
+        rewriteRows.insert(rewriteRows.end(), missingRows.begin(), missingRows.end());
+    }
+    
+    if (!rewriteRows.empty()) {
+        std::vector<std::string> changedPks;
+        std::vector<std::vector<std::string>> changedData;
+        std::vector<std::string> changedHashes;
+        std::vector<std::string> changedColumnHashes;
+        
+        for (size_t i : rewriteRows) {
+            changedPks.push_back(batch.pkValues[i]);
+            changedData.push_back((*batch.batchData)[i]);
+            changedHashes.push_back(hashed.rowHashes[i]);
+            changedColumnHashes.push_back(columnGroupSize > 0 ? hashed.columnHashes[i] : "");
+        }
+        
+        ProcessHashBasedBatch(tableName, columns, tableInfo.pkColumns, changedPks, changedData,
+                              changedHashes, changedColumnHashes);
+    }
+    
+    if (checkpoint && !batch.pkValues.empty()) {
+        syncState->SetCheckpoint(tableName, "hash_based", runId, batch.pkValues.back(), rowsThrough);
+    }
+    sqliteHelper.CommitTransaction();
+    sqliteHelper.BeginTransaction();
+    
+    double waitSeconds = std::chrono::duration<double>(waitEnd - waitStart).count();
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch.fetchStart).count();
+    stats.hashSeconds += hashed.hashSeconds;
+    runStats.hashSeconds += hashed.hashSeconds;
+    stats.waitSeconds += waitSeconds;
+    stats.batchSeconds += batchSeconds;
+    
+    float hashPct = (batchSeconds > 0) ? static_cast<float>(hashed.hashSeconds / batchSeconds * 100) : 0;
+    std::string partialInfo = columnGroupSize > 0 ? 
+        ", " + std::to_string(columnUpdates.size()) + " partial" : "";
+    logger->Info("Processed " + std::to_string(batch.batchData->size()) + " rows for " + tableName + 
+               ", found " + std::to_string(changedCount) + " changes" + partialInfo + " (hashing " + 
+               std::to_string(hashPct) + "% of batch time)");
+    
+    return static_cast<int>(changedCount);
+}
+
+std::vector<size_t> TableSyncer::ProcessColumnUpdates(
+    const TableInfo& tableInfo,
+    const std::vector<std::string>& pkValues,
+    const std::vector<std::vector<std::string>>& batchData,
+    const HashBatchResult& hashed,
+    const std::vector<ColumnUpdate>& updates) {
+    
+    const std::string& tableName = tableInfo.tableName;
+    const std::vector<std::string>& columns = tableInfo.columns;
+    std::vector<size_t> missingRows;
+    
+    // Rows touching the same columns share one prepared UPDATE
+    std::map<std::vector<size_t>, sqlite3_stmt*> updateStmts;
+    
+    for (const auto& update : updates) {
+        sqlite3_stmt*& updateStmt = updateStmts[update.columnIndexes];
+        
+        if (!updateStmt) {
+            std::string updateSql = "UPDATE " + tableName + " SET ";
+            for (size_t i = 0; i < update.columnIndexes.size(); ++i) {
+                updateSql += "\"" + columns[update.columnIndexes[i]] + "\" = ?";
+                if (i < update.columnIndexes.size() - 1) {
+                    updateSql += ", ";
+                }
+            }
+            updateSql += " WHERE ";
+            for (size_t i = 0; i < tableInfo.pkColumns.size(); ++i) {
+                updateSql += "\"" + tableInfo.pkColumns[i] + "\" = ?";
+                if (i < tableInfo.pkColumns.size() - 1) {
+                    updateSql += " AND ";
+                }
+            }
+            
+            updateStmt = sqliteHelper.PrepareStatement(updateSql);
+            if (!updateStmt) {
+                missingRows.push_back(update.rowIndex);
+                continue;
+            }
+        }
+        
+        std::vector<std::string> keyParts = KeyCodec::Decode(pkValues[update.rowIndex], tableInfo.pkColumns.size());
+        if (keyParts.empty()) {
+            missingRows.push_back(update.rowIndex);
+            continue;
+        }
+        
+        const auto& row = batchData[update.rowIndex];
+        sqlite3_reset(updateStmt);
+        
+        for (size_t i = 0; i < update.columnIndexes.size(); ++i) {
+            sqliteHelper.BindParameter(updateStmt, i + 1, row[update.columnIndexes[i]]);
+        }
+        for (size_t i = 0; i < keyParts.size(); ++i) {
+            sqliteHelper.BindParameter(updateStmt, update.columnIndexes.size() + i + 1, keyParts[i]);
+        }
+        
+        int rc = sqlite3_step(updateStmt);
+        if (rc != SQLITE_DONE) {
+            logger->Error("Error updating row: " + std::string(sqlite3_errmsg(sqlite3_db_handle(updateStmt))));
+        } else if (sqlite3_changes(sqlite3_db_handle(updateStmt)) == 0) {
+            missingRows.push_back(update.rowIndex);
+        } else {
+            hashDb->StoreHash(tableName, pkValues[update.rowIndex], 
+                              hashed.rowHashes[update.rowIndex], hashed.columnHashes[update.rowIndex]);
+        }
+    }
+    
+    for (auto& entry : updateStmts) {
+        if (entry.second) {
+            sqlite3_finalize(entry.second);
+        }
+    }
+    
+    return missingRows;
+}
+
+int TableSyncer::ApplyHashDeletes(const TableInfo& tableInfo, const std::vector<std::string>& deletedKeys) {
+    const std::string& tableName = tableInfo.tableName;
+    
+    if (deletedKeys.empty()) {
+        return 0;
+    }
+    
+    logger->Info("Found " + std::to_string(deletedKeys.size()) + " rows deleted from source table " + tableName);
+    
+    int rowsDeleted = 0;
+    for (size_t offset = 0; offset < deletedKeys.size(); offset += batchSize) {
+        size_t end = std::min(deletedKeys.size(), offset + static_cast<size_t>(batchSize));
+        std::vector<std::string> chunk(deletedKeys.begin() + offset, deletedKeys.begin() + end);
+        
+        sqliteHelper.BeginTransaction();
+        if (!DeleteKeyedRows(tableName, tableInfo.pkColumns, chunk)) {
+            logger->Error("Error deleting removed rows from " + tableName);
+            sqliteHelper.RollbackTransaction();
+            break;
+        }
+        sqliteHelper.CommitTransaction();
+        
+        // Hashes go only after the mirror rows are gone, so a failure here is retried next run
+        hashDb->DeleteHashes(tableName, chunk);
+        rowsDeleted += static_cast<int>(chunk.size());
+        runStats.rowsDeleted += static_cast<int>(chunk.size());
+        
+        logger->Info("Deleted " + std::to_string(chunk.size()) + " rows from " + tableName + 
+                    " (total: " + std::to_string(rowsDeleted) + " of " + std::to_string(deletedKeys.size()) + ")");
+    }
+    
+    return rowsDeleted;
+}
+
+void TableSyncer::ProcessHashBasedBatch(
+    const std::string& tableName,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& pkColumns,
+    const std::vector<std::string>& pkValues,
+    const std::vector<std::vector<std::string>>& batchData,
+    const std::vector<std::string>& rowHashes,
+    const std::vector<std::string>& columnHashes) {
+    
+    if (pkValues.empty() || batchData.empty()) {
+        return;
+    }
+    
+    try {
+        // Delete existing rows
+        if (!DeleteKeyedRows(tableName, pkColumns, pkValues)) {
+            logger->Error("Error deleting existing rows for hash-based sync");
+            return;
+        }
+        
+        // Insert updated rows
+        std::string insertSql = "INSERT INTO " + tableName + " (";
+        for (size_t i = 0; i < columns.size(); ++i) {
+            insertSql += "\"" + columns[i] + "\"";
             if (i < columns.size() - 1) {
                 insertSql += ", ";
             }
@@ -828,8 +2374,7 @@ void TableSyncer::ProcessHashBasedBatch(
                 logger->Error("Error inserting row: " + std::string(sqlite3_errmsg(sqlite3_db_handle(insertStmt))));
             } else {
                 // Update hash in the hash database
-                std::string rowHash = HashCalculator::CalculateRowHash(row);
-hashDb->StoreHash(tableName, pkValue, rowHash);
+                hashDb->StoreHash(tableName, pkValue, rowHashes[rowIdx], columnHashes[rowIdx]);
             }
         }
         
@@ -847,7 +2392,12 @@ bool TableSyncer::EnsureTargetTable(const TableInfo& tableInfo) {
     }
     
     const std::string& tableName = tableInfo.tableName;
-    const std::vector<std::string>& columns = tableInfo.columns;
+    
+    // Source columns plus the mirror-only digest tag
+    std::vector<std::string> columns = tableInfo.columns;
+    if (!tableInfo.digestColumn.empty()) {
+        columns.push_back(tableInfo.digestColumn);
+    }
     
     try {
         // Check if table exists
@@ -920,6 +2470,38 @@ bool TableSyncer::EnsureTargetTable(const TableInfo& tableInfo) {
                     }
                 }
             }
+            
+            // Excluded columns keep their mirrored values unless the table asks for them to be dropped
+            auto settings = config.tables.find(tableName);
+            bool dropExcluded = settings != config.tables.end() && settings->second.dropExcludedColumns;
+            for (const auto& col : tableInfo.excludedColumns) {
+                if (!dropExcluded || existingColumns.find(col) == existingColumns.end()) {
+                    continue;
+                }
+                
+                // DROP COLUMN needs SQLite 3.35; older libraries leave the column alone
+                if (sqlite3_libversion_number() < 3035000) {
+                    logger->Warning("SQLite " + std::string(sqlite3_libversion()) + " cannot drop column " + col + 
+                                   " from table " + tableName + ", keeping it");
+                    continue;
+                }
+                
+                if (!sqliteHelper.ExecuteNonQuery("ALTER TABLE " + tableName + " DROP COLUMN \"" + col + "\"")) {
+                    logger->Warning("Failed to drop excluded column " + col + " from table " + tableName);
+                } else {
+                    logger->Info("Dropped excluded column " + col + " from table " + tableName);
+                }
+            }
+        }
+        
+        // Deletes and updates of a ROWID-keyed table look rows up by it, multiset deletes by digest
+        std::string lookupColumn = !tableInfo.rowidColumn.empty() ? tableInfo.rowidColumn : tableInfo.digestColumn;
+        if (!lookupColumn.empty()) {
+            std::string indexSql = "CREATE INDEX IF NOT EXISTS idx_" + tableName + "_" + lookupColumn + 
+                                   " ON " + tableName + " (\"" + lookupColumn + "\")";
+            if (!sqliteHelper.ExecuteNonQuery(indexSql)) {
+                return false;
+            }
         }
         
         return true;
@@ -929,8 +2511,9 @@ bool TableSyncer::EnsureTargetTable(const TableInfo& tableInfo) {
     }
 }
 
-int TableSyncer::GetSourceRowCount(const std::string& tableName) {
-    std::string countSql = "SELECT COUNT(*) FROM PUB." + tableName;
+int TableSyncer::GetSourceRowCount(const TableInfo& tableInfo) {
+    const std::string& tableName = tableInfo.tableName;
+    std::string countSql = "SELECT COUNT(*) FROM PUB." + tableName + SourceWhere(tableInfo, "");
     SQLHSTMT stmt = odbcHelper.ExecuteQuery(countSql);
     
     if (stmt == SQL_NULL_HSTMT) {
@@ -951,21 +2534,312 @@ int TableSyncer::GetSourceRowCount(const std::string& tableName) {
     return count;
 }
 
-std::string TableSyncer::FindTimestampColumn(const std::vector<std::string>& columns) {
-    for (const auto& col : columns) {
-        std::string lowerCol = col;
-        std::transform(lowerCol.begin(), lowerCol.end(), lowerCol.begin(),
-                      [](unsigned char c) { return std::tolower(c); });
+void TableSyncer::ShiftTimestamp(SQL_TIMESTAMP_STRUCT& timestamp, int seconds) {
+    // Civil-date arithmetic on the struct itself; the value is server-local time with no zone
+    long long y = timestamp.month <= 2 ? timestamp.year - 1 : timestamp.year;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (timestamp.month + (timestamp.month > 2 ? -3 : 9)) + 2) / 5 + timestamp.day - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long long days = era * 146097 + doe;
+    
+    long long total = days * 86400 + timestamp.hour * 3600 + timestamp.minute * 60 + timestamp.second + seconds;
+    days = (total >= 0 ? total : total - 86399) / 86400;
+    long long secondOfDay = total - days * 86400;
+    
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    long long month = mp < 10 ? mp + 3 : mp - 9;
+    
+    timestamp.year = static_cast<SQLSMALLINT>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+    timestamp.month = static_cast<SQLUSMALLINT>(month);
+    timestamp.day = static_cast<SQLUSMALLINT>(doy - (153 * mp + 2) / 5 + 1);
+    timestamp.hour = static_cast<SQLUSMALLINT>(secondOfDay / 3600);
+    timestamp.minute = static_cast<SQLUSMALLINT>(secondOfDay % 3600 / 60);
+    timestamp.second = static_cast<SQLUSMALLINT>(secondOfDay % 60);
+}
+
+std::string TableSyncer::FormatTimestamp(const SQL_TIMESTAMP_STRUCT& timestamp, bool dateOnly) {
+    char text[64];
+    if (dateOnly) {
+        snprintf(text, sizeof(text), "%04d-%02u-%02u", timestamp.year, timestamp.month, timestamp.day);
+    } else {
+        snprintf(text, sizeof(text), "%04d-%02u-%02u %02u:%02u:%02u", timestamp.year, timestamp.month, timestamp.day, 
+                 timestamp.hour, timestamp.minute, timestamp.second);
+    }
+    return text;
+}
+
+bool TableSyncer::IsLaterValue(const std::string& value, const std::string& current) {
+    if (value.empty()) {
+        return false;
+    }
+    
+    // Numbers compare by value, anything else as the text the server compared
+    char* valueEnd = nullptr;
+    char* currentEnd = nullptr;
+    double valueNumber = std::strtod(value.c_str(), &valueEnd);
+    double currentNumber = std::strtod(current.c_str(), &currentEnd);
+    if (!current.empty() && *valueEnd == '\0' && *currentEnd == '\0') {
+        return valueNumber > currentNumber;
+    }
+    
+    return value > current;
+}
+
+int TableSyncer::CompareTimestamps(const SQL_TIMESTAMP_STRUCT& a, const SQL_TIMESTAMP_STRUCT& b) {
+    auto left = std::make_tuple(a.year, a.month, a.day, a.hour, a.minute, a.second, a.fraction);
+    auto right = std::make_tuple(b.year, b.month, b.day, b.hour, b.minute, b.second, b.fraction);
+    
+    if (left < right) {
+        return -1;
+    }
+    return left == right ? 0 : 1;
+}
+
+bool TableSyncer::BindKeyParameter(SQLHSTMT stmt, int paramIndex, const TableInfo& tableInfo, size_t keyPart,
+                                   const std::string& value, OdbcParam& storage) {
+    // Key values are bound as the key column's own type so the comparison can use its index
+    int keyType = keyPart < tableInfo.plan.keyTypes.size() ? tableInfo.plan.keyTypes[keyPart] : tableInfo.plan.keyType;
+    return odbcHelper.BindTypedParameter(stmt, paramIndex, keyType, value, storage);
+}
+
+std::vector<int> TableSyncer::GetKeyIndexes(const TableInfo& tableInfo) {
+    std::vector<int> keyIndexes;
+    
+    for (const auto& pkColumn : tableInfo.pkColumns) {
+        auto it = std::find(tableInfo.columns.begin(), tableInfo.columns.end(), pkColumn);
+        if (it == tableInfo.columns.end()) {
+            return std::vector<int>();
+        }
+        keyIndexes.push_back(static_cast<int>(it - tableInfo.columns.begin()));
+    }
+    
+    return keyIndexes;
+}
+
+std::string TableSyncer::SourceColumn(const TableInfo& tableInfo, const std::string& column) {
+    // The ROWID pseudo-column is read under its own name and stored under rowidColumn
+    if (!tableInfo.rowidColumn.empty() && column == tableInfo.rowidColumn) {
+        return "ROWID";
+    }
+    
+    return "\"" + column + "\"";
+}
+
+std::string TableSyncer::SelectList(const TableInfo& tableInfo) {
+    std::string selectList;
+    for (size_t i = 0; i < tableInfo.columns.size(); ++i) {
+        selectList += SourceColumn(tableInfo, tableInfo.columns[i]);
+        if (i < tableInfo.columns.size() - 1) {
+            selectList += ", ";
+        }
+    }
+    
+    return selectList;
+}
+
+std::string TableSyncer::KeyColumnList(const TableInfo& tableInfo) {
+    std::string columnList;
+    for (size_t i = 0; i < tableInfo.pkColumns.size(); ++i) {
+        columnList += SourceColumn(tableInfo, tableInfo.pkColumns[i]);
+        if (i < tableInfo.pkColumns.size() - 1) {
+            columnList += ", ";
+        }
+    }
+    
+    return columnList;
+}
+
+std::string TableSyncer::KeyPredicate(const TableInfo& tableInfo, const std::string& op) {
+    const std::vector<std::string>& pkColumns = tableInfo.pkColumns;
+    
+    if (pkColumns.size() == 1) {
+        return SourceColumn(tableInfo, pkColumns[0]) + " " + op + " ?";
+    }
+    
+    // (a, b) > (?, ?) spelled out as (a > ?) OR (a = ? AND b > ?), which the leading
+    // column's index can still serve; only the last column takes the inclusive operator
+    std::string strictOp = op.substr(0, 1);
+    std::string predicate = "(";
+    for (size_t i = 0; i < pkColumns.size(); ++i) {
+        predicate += "(";
+        for (size_t j = 0; j < i; ++j) {
+            predicate += SourceColumn(tableInfo, pkColumns[j]) + " = ? AND ";
+        }
+        predicate += SourceColumn(tableInfo, pkColumns[i]) + " " + (i < pkColumns.size() - 1 ? strictOp : op) + " ?)";
+        if (i < pkColumns.size() - 1) {
+            predicate += " OR ";
+        }
+    }
+    
+    return predicate + ")";
+}
+
+std::string TableSyncer::SourceWhere(const TableInfo& tableInfo, const std::string& predicate) {
+    if (tableInfo.sourceFilter.empty()) {
+        return predicate.empty() ? "" : " WHERE " + predicate;
+    }
+    
+    // The configured filter is parenthesised so its ORs cannot bind to the key predicate
+    return " WHERE " + (predicate.empty() ? "" : predicate + " AND ") + "(" + tableInfo.sourceFilter + ")";
+}
+
+bool TableSyncer::BindKeyPredicate(SQLHSTMT stmt, int& paramIndex, const TableInfo& tableInfo,
+                                   const std::string& key, std::deque<OdbcParam>& storage) {
+    std::vector<std::string> keyParts = KeyCodec::Decode(key, tableInfo.pkColumns.size());
+    if (keyParts.empty()) {
+        logger->Error("Stored key '" + key + "' does not match the key columns of " + tableInfo.tableName);
+        return false;
+    }
+    
+    // Parameters in the order KeyPredicate writes them
+    for (size_t i = 0; i < keyParts.size(); ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            storage.emplace_back();
+            if (!BindKeyParameter(stmt, paramIndex++, tableInfo, j, keyParts[j], storage.back())) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool TableSyncer::DeleteKeyedRows(const std::string& tableName, const std::vector<std::string>& pkColumns,
+                                  const std::vector<std::string>& keys) {
+    if (pkColumns.size() == 1) {
+        return sqliteHelper.DeleteRows(tableName, pkColumns[0], keys);
+    }
+    
+    std::vector<std::vector<std::string>> keyParts;
+    for (const auto& key : keys) {
+        std::vector<std::string> parts = KeyCodec::Decode(key, pkColumns.size());
+        if (!parts.empty()) {
+            keyParts.push_back(parts);
+        }
+    }
+    
+    return sqliteHelper.DeleteRows(tableName, pkColumns, keyParts);
+}
+
+bool TableSyncer::FetchRowsByKey(const TableInfo& tableInfo, const std::vector<std::string>& keys,
+                                 std::vector<std::string>& pkValues, std::vector<std::vector<std::string>>& rows) {
+    if (keys.empty()) {
+        return true;
+    }
+    
+    // A key whose row no longer passes the source filter reads as deleted
+    std::string baseSql = "SELECT " + SelectList(tableInfo) + " FROM PUB." + tableInfo.tableName + " WHERE ";
+    if (!tableInfo.sourceFilter.empty()) {
+        baseSql += "(" + tableInfo.sourceFilter + ") AND ";
+    }
+    size_t chunk = GetKeyFetchChunk(tableInfo, baseSql);
+    std::vector<int> keyIndexes = GetKeyIndexes(tableInfo);
+    
+    // Every full chunk reuses one prepared statement; only a short final chunk needs its own
+    SQLHSTMT chunkStmt = SQL_NULL_HSTMT;
+    bool fetched = true;
+    
+    for (size_t start = 0; start < keys.size() && fetched; start += chunk) {
+        size_t count = std::min(chunk, keys.size() - start);
+        SQLHSTMT stmt = chunkStmt;
+        
+        if (count < chunk || stmt == SQL_NULL_HSTMT) {
+            stmt = odbcHelper.PrepareStatement(baseSql + KeyListPredicate(tableInfo, count));
+            if (stmt == SQL_NULL_HSTMT) {
+                fetched = false;
+                break;
+            }
+            if (count == chunk) {
+                chunkStmt = stmt;
+            }
+        }
+        
+        int paramIndex = 1;
+        std::deque<OdbcParam> keyParams;
+        for (size_t i = start; i < start + count && fetched; ++i) {
+            std::vector<std::string> keyParts = KeyCodec::Decode(keys[i], tableInfo.pkColumns.size());
+            if (keyParts.empty()) {
+                logger->Error("Key '" + keys[i] + "' does not match the key columns of " + tableInfo.tableName);
+                fetched = false;
+            }
+            for (size_t j = 0; j < keyParts.size() && fetched; ++j) {
+                keyParams.emplace_back();
+                fetched = BindKeyParameter(stmt, paramIndex++, tableInfo, j, keyParts[j], keyParams.back());
+            }
+        }
         
-        // Look for common timestamp column patterns
-        if (lowerCol.find("timestamp") != std::string::npos || 
-            lowerCol.find("modified") != std::string::npos ||
-            lowerCol.find("updated") != std::string::npos ||
-            lowerCol.find("changed") != std::string::npos ||
-            lowerCol.find("datetime") != std::string::npos) {
-            return col;
+        if (fetched && odbcHelper.ExecutePreparedStatement(stmt)) {
+            while (odbcHelper.FetchRow(stmt)) {
+                std::vector<std::string> rowData;
+                for (size_t i = 0; i < tableInfo.columns.size(); ++i) {
+                    rowData.push_back(odbcHelper.GetColumnData(stmt, i + 1));
+                }
+                pkValues.push_back(KeyCodec::Extract(rowData, keyIndexes));
+                rows.push_back(rowData);
+            }
+            fetched = !odbcHelper.LastFetchFailed();
+        } else {
+            fetched = false;
+        }
+        
+        if (stmt == chunkStmt) {
+            fetched = odbcHelper.CloseCursor(stmt) && fetched;
+        } else {
+            odbcHelper.FreeStatement(stmt);
+        }
+    }
+    
+    if (chunkStmt != SQL_NULL_HSTMT) {
+        odbcHelper.FreeStatement(chunkStmt);
+    }
+    
+    if (!fetched) {
+        logger->Error("Error fetching rows of " + tableInfo.tableName + " by key");
+    }
+    return fetched;
+}
+
+std::string TableSyncer::KeyListPredicate(const TableInfo& tableInfo, size_t count) {
+    const std::vector<std::string>& pkColumns = tableInfo.pkColumns;
+    
+    if (pkColumns.size() == 1) {
+        std::string predicate = SourceColumn(tableInfo, pkColumns[0]) + " IN (";
+        for (size_t i = 0; i < count; ++i) {
+            predicate += i == 0 ? "?" : ", ?";
         }
+        return predicate + ")";
+    }
+    
+    // Row-value IN lists are not portable, so composite keys are OR'd equality groups
+    std::string group = "(";
+    for (size_t j = 0; j < pkColumns.size(); ++j) {
+        group += SourceColumn(tableInfo, pkColumns[j]) + " = ?";
+        group += j < pkColumns.size() - 1 ? " AND " : ")";
+    }
+    
+    std::string predicate = "(";
+    for (size_t i = 0; i < count; ++i) {
+        predicate += i == 0 ? group : " OR " + group;
+    }
+    return predicate + ")";
+}
+
+size_t TableSyncer::GetKeyFetchChunk(const TableInfo& tableInfo, const std::string& baseSql) {
+    size_t chunk = static_cast<size_t>(std::max(1, config.mirrorSettings.keyFetchChunk));
+    
+    // Shrink the chunk until its statement fits the driver's length limit, if it has one
+    SQLUINTEGER maxLength = odbcHelper.GetMaxStatementLength();
+    if (maxLength > 0) {
+        size_t firstKeyLength = baseSql.size() + KeyListPredicate(tableInfo, 1).size();
+        size_t perKeyLength = KeyListPredicate(tableInfo, 2).size() - KeyListPredicate(tableInfo, 1).size();
+        size_t fits = maxLength > firstKeyLength ? (maxLength - firstKeyLength) / perKeyLength + 1 : 1;
+        chunk = std::min(chunk, fits);
     }
     
-    return "";
+    return chunk;
 }
\ No newline at end of file
@@ -4,20 +4,33 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <future>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <map>
 #include "SqliteHelper.h"
 #include "OdbcHelper.h"
 #include "HashStorage.h"
+#include "HashWorkerPool.h"
 #include "SyncState.h"
+#include "SyncHistory.h"
+#include "StrategyAdvisor.h"
+#include "BatchSizer.h"
 #include "Logger.h"
 #include "TableInfo.h"
+#include "Config.h"
 
 class TableSyncer {
 public:
     TableSyncer(SqliteHelper& sqliteHelper, 
                OdbcHelper& odbcHelper,
                std::shared_ptr<SyncState> syncState,
+               std::shared_ptr<SyncHistory> syncHistory,
                std::shared_ptr<HashStorage> hashDb,
+               std::shared_ptr<HashWorkerPool> hashPool,
                std::shared_ptr<Logger> logger,
+               const Config& config,
                int batchSize);
                
     int SyncTable(const TableInfo& tableInfo, bool fullSync);
@@ -26,39 +39,214 @@ private:
     SqliteHelper& sqliteHelper;
     OdbcHelper& odbcHelper;
     std::shared_ptr<SyncState> syncState;
+    std::shared_ptr<SyncHistory> syncHistory;
     std::shared_ptr<HashStorage> hashDb;
+    std::shared_ptr<HashWorkerPool> hashPool;
     std::shared_ptr<Logger> logger;
+    const Config& config;
     int batchSize;
+    int defaultBatchSize;   // batchSize of tables without their own batch_size
     bool hashEnabled;
+    std::string runId;   // Recorded with checkpoints so a resume names the run it continues
+    StrategyAdvisor advisor;
+    BatchSizer batchSizer;
+    bool tuneBatches;       // Off for tables with a configured batch_size
+    
+    // What the running strategy changed, split where it can tell, for the sync history
+    struct RunStats {
+        int rowsInserted;
+        int rowsUpdated;
+        int rowsDeleted;
+        double hashSeconds;
+    };
+    RunStats runStats;
+    
+    // A fetched batch waiting on the hash workers before diff and write
+    struct PendingHashBatch {
+        PendingHashBatch() : batchData(std::make_shared<std::vector<std::vector<std::string>>>()) {}
+        
+        std::vector<std::string> pkValues;
+        // Shared with the hash worker rather than copied; filled only before the batch is submitted
+        std::shared_ptr<std::vector<std::vector<std::string>>> batchData;
+        std::future<HashBatchResult> hashes;
+        std::chrono::steady_clock::time_point fetchStart;
+    };
+    
+    // A changed row whose stored column digests allow an in-place UPDATE
+    struct ColumnUpdate {
+        size_t rowIndex;
+        std::vector<size_t> columnIndexes;
+    };
+    
+    // Per-table timing for the hash stage
+    struct HashStageStats {
+        double hashSeconds;
+        double waitSeconds;
+        double batchSeconds;
+    };
     
     // Sync strategies
     std::string GetSyncStrategy(const TableInfo& tableInfo, bool fullSync);
+    // The table's configured strategy when the table can run it; empty otherwise
+    std::string GetConfiguredStrategy(const TableInfo& tableInfo);
+    std::string AdviseStrategy(const TableInfo& tableInfo, const std::string& strategy);
+    void RecordRun(const TableInfo& tableInfo, const std::string& strategy, int rowsSynced,
+                   const OdbcFetchStats& fetchStart, std::chrono::steady_clock::time_point start);
+    // Under auto_batch_size, resizes batchSize from the batch that just ended
+    void TuneBatchSize();
     int SyncFullTable(const TableInfo& tableInfo);
     int SyncKeyBased(const TableInfo& tableInfo);
     int SyncTimestampBased(const TableInfo& tableInfo);
     int SyncHashBased(const TableInfo& tableInfo);
+    int SyncRollingHash(const TableInfo& tableInfo);
+    int SyncHashFingerprinted(const TableInfo& tableInfo, const std::string& modColumn, int bucketRows);
+    int SyncMultiset(const TableInfo& tableInfo);
+    int SyncCdc(const TableInfo& tableInfo);
+    
+    // Source isolation while the table is read: its own override, else the connection default
+    std::string GetIsolationLevel(const std::string& tableName);
+    int GetTableBatchSize(const std::string& tableName);
+    
+    // Rolling verification: new keys every run plus one hash-verified key slice
+    bool UseRollingVerification(const std::string& tableName, int rowCount);
+    int GetVerifySliceRows(const std::string& tableName, int rowCount);
+    
+    // Range fingerprints: COUNT/MAX(key)/MAX(modification column) per key range,
+    // so only ranges whose aggregate moved are fetched and hashed
+    int GetFingerprintBucketRows(const std::string& tableName);
+    bool DiscoverKeyRanges(
+        const TableInfo& tableInfo,
+        int bucketRows,
+        std::vector<HashStorage::RangeFingerprint>& ranges);
+    std::string QueryRangeFingerprint(
+        const TableInfo& tableInfo,
+        const std::string& modColumn,
+        const HashStorage::RangeFingerprint& range);
+    bool SyncKeyRange(
+        const TableInfo& tableInfo,
+        const std::vector<int>& keyIndexes,
+        const HashStorage::RangeFingerprint& range,
+        int& rowsSynced,
+        int& rowsDeleted);
+    SQLHSTMT ExecuteRangeQuery(
+        const std::string& selectSql,
+        const TableInfo& tableInfo,
+        const HashStorage::RangeFingerprint& range,
+        const std::string& suffix);
+    int FingerprintRowCount(const std::string& fingerprint);
+    
+    // Mirror rows at or after the lower bound of a timestamp sync's overlap window, counted
+    // by row image so re-read rows that are already mirrored can be skipped
+    bool LoadOverlapRows(const TableInfo& tableInfo, const std::string& lowerBound,
+                         std::unordered_map<std::string, int>& copies);
+    
+    // Keyless multiset diff: mirror rows carry their row digest, so the mirror's
+    // (digest, count) groups are compared with the digests of a full source scan
+    bool LoadMirrorDigests(const TableInfo& tableInfo, std::unordered_map<std::string, int>& digests, int& untagged);
+    int ApplyMultisetBatch(
+        const TableInfo& tableInfo,
+        PendingHashBatch& batch,
+        std::unordered_map<std::string, int>& remaining,
+        sqlite3_stmt* insertStmt);
+    int DeleteMultisetRows(const TableInfo& tableInfo, const std::unordered_map<std::string, int>& remaining);
+    std::string BuildInsertSql(const TableInfo& tableInfo);
+    
+    // OpenEdge CDC: change rows are read past the stored sequence and each batch is
+    // collapsed to the last change per key before it is applied
+    static constexpr int CDC_CREATE = 1;
+    static constexpr int CDC_DELETE = 2;
+    static constexpr int CDC_UPDATE_BEFORE = 3;
+    static constexpr int CDC_UPDATE_AFTER = 4;
+    
+    struct CdcChange {
+        int operation;
+        std::vector<std::string> rowData;
+    };
+    
+    bool QueryCdcHighWater(const TableInfo& tableInfo, long long& sequence);
+    // Rows written, or -1 when the rows to apply could not be re-read from the source
+    int ApplyCdcBatch(const TableInfo& tableInfo, const std::map<std::string, CdcChange>& changes);
     
     // Batch processing
+    std::future<HashBatchResult> SubmitHashBatch(
+        std::shared_ptr<const std::vector<std::vector<std::string>>> batchData, bool columnHashes = true);
+    
+    // Streams an executed source query through hash, diff and write; stops after
+    // maxRows rows when maxRows > 0 and reports the last key read. With checkpoint
+    // set, every batch commit records a hash_based checkpoint; rowsRead counts on
+    // from the value passed in. markSeen is cleared if a batch's keys could not be marked seen
+    int RunHashPipeline(
+        const TableInfo& tableInfo,
+        SQLHSTMT stmt,
+        const std::vector<int>& keyIndexes,
+        int maxRows,
+        bool& markSeen,
+        bool checkpoint,
+        std::string& lastKey,
+        int& rowsRead,
+        std::vector<std::string>* keysRead = nullptr);
+    int ApplyHashBatch(
+        const TableInfo& tableInfo,
+        PendingHashBatch& batch,
+        HashStageStats& stats,
+        bool& markSeen,
+        bool checkpoint,
+        int rowsThrough);
+    int ApplyHashDeletes(const TableInfo& tableInfo, const std::vector<std::string>& deletedKeys);
+    std::vector<size_t> ProcessColumnUpdates(
+        const TableInfo& tableInfo,
+        const std::vector<std::string>& pkValues,
+        const std::vector<std::vector<std::string>>& batchData,
+        const HashBatchResult& hashed,
+        const std::vector<ColumnUpdate>& updates);
+    
     void ProcessHashBasedBatch(
         const std::string& tableName,
         const std::vector<std::string>& columns,
-        const std::string& pkColumn,
+        const std::vector<std::string>& pkColumns,
         const std::vector<std::string>& pkValues,
-        const std::vector<std::vector<std::string>>& batchData);
+        const std::vector<std::vector<std::string>>& batchData,
+        const std::vector<std::string>& rowHashes,
+        const std::vector<std::string>& columnHashes);
         
     void ProcessKeyBasedBatch(
         const std::string& tableName, 
         const std::vector<std::string>& columns, 
-        const std::string& pkColumn,
+        const std::vector<std::string>& pkColumns,
         const std::vector<std::string>& pkValues, 
         const std::vector<std::vector<std::string>>& batchData);
         
     // Table management
     bool EnsureTargetTable(const TableInfo& tableInfo);
-    int GetSourceRowCount(const std::string& tableName);
+    int GetSourceRowCount(const TableInfo& tableInfo);
+    
+    // Keys, single-column or composite; key values travel as KeyCodec strings
+    std::vector<int> GetKeyIndexes(const TableInfo& tableInfo);
+    std::string SourceColumn(const TableInfo& tableInfo, const std::string& column);
+    std::string SelectList(const TableInfo& tableInfo);
+    std::string KeyColumnList(const TableInfo& tableInfo);
+    std::string KeyPredicate(const TableInfo& tableInfo, const std::string& op);
+    // " WHERE predicate", with the table's source filter ANDed on; empty when there is neither
+    std::string SourceWhere(const TableInfo& tableInfo, const std::string& predicate);
+    bool BindKeyPredicate(SQLHSTMT stmt, int& paramIndex, const TableInfo& tableInfo,
+                          const std::string& key, std::deque<OdbcParam>& storage);
+    bool DeleteKeyedRows(const std::string& tableName, const std::vector<std::string>& pkColumns,
+                         const std::vector<std::string>& keys);
+    
+    // Looks up the current source rows for a set of keys, a chunk of keys per statement;
+    // keys the source no longer has are simply absent from rows
+    bool FetchRowsByKey(const TableInfo& tableInfo, const std::vector<std::string>& keys,
+                        std::vector<std::string>& pkValues, std::vector<std::vector<std::string>>& rows);
+    std::string KeyListPredicate(const TableInfo& tableInfo, size_t count);
+    size_t GetKeyFetchChunk(const TableInfo& tableInfo, const std::string& baseSql);
     
     // Helper methods
-    std::string FindTimestampColumn(const std::vector<std::string>& columns);
+    bool BindKeyParameter(SQLHSTMT stmt, int paramIndex, const TableInfo& tableInfo, size_t keyPart,
+                          const std::string& value, OdbcParam& storage);
+    void ShiftTimestamp(SQL_TIMESTAMP_STRUCT& timestamp, int seconds);
+    int CompareTimestamps(const SQL_TIMESTAMP_STRUCT& a, const SQL_TIMESTAMP_STRUCT& b);
+    std::string FormatTimestamp(const SQL_TIMESTAMP_STRUCT& timestamp, bool dateOnly);
+    bool IsLaterValue(const std::string& value, const std::string& current);
 };
 
 #endif // TABLE_SYNCER_H
\ No newline at end of file
@@ -1,19 +1,27 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cstdlib>
 #include "DataSyncManager.h"
+#include "SourceGroup.h"
 
 void PrintUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  --full-sync            Perform full sync of all tables" << std::endl;
-    std::cout << "  --ignore-table TABLE   Tables to ignore (can be used multiple times)" << std::endl;
+    std::cout << "  --daemon               Keep running and sync each table again when it reaches its interval" << std::endl;
+    std::cout << "  --rebuild-hashes       Recompute the hash database from the SQLite mirror (no source access)" << std::endl;
+    std::cout << "  --time-budget SECONDS  Start no table that is not predicted to finish within SECONDS" << std::endl;
+    std::cout << "  --ignore-table TABLE   Tables to ignore (can be used multiple times; applies to every source)" << std::endl;
     std::cout << "  --config FILE          Path to configuration file (default: config.json)" << std::endl;
     std::cout << "  --help                 Display this help message" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     bool fullSync = false;
+    bool rebuildHashes = false;
+    bool daemon = false;
+    int timeBudgetSeconds = 0;
     std::vector<std::string> ignoreTables;
     std::string configFile = "config.json";
     
@@ -23,6 +31,16 @@ int main(int argc, char* argv[]) {
         
         if (arg == "--full-sync") {
             fullSync = true;
+        } else if (arg == "--daemon") {
+            daemon = true;
+        } else if (arg == "--rebuild-hashes") {
+            rebuildHashes = true;
+        } else if (arg == "--time-budget" && i + 1 < argc) {
+            timeBudgetSeconds = std::atoi(argv[++i]);
+            if (timeBudgetSeconds <= 0) {
+                std::cerr << "Invalid time budget: " << argv[i] << std::endl;
+                return 1;
+            }
         } else if (arg == "--ignore-table" && i + 1 < argc) {
             ignoreTables.push_back(argv[++i]);
         } else if (arg == "--config" && i + 1 < argc) {
@@ -38,9 +56,30 @@ int main(int argc, char* argv[]) {
     }
     
     try {
-        // Create DataSyncManager with the specified config file
-        DataSyncManager syncer(configFile, fullSync, ignoreTables);
-        syncer.RunSync();
+        Config config(configFile);
+        
+        // Several sources share one scheduler; a single one runs as before
+        if (!config.sources.empty()) {
+            SourceGroup group(config, fullSync, ignoreTables, timeBudgetSeconds);
+            if (rebuildHashes) {
+                group.RebuildHashes();
+            } else if (daemon) {
+                group.RunDaemon();
+            } else {
+                group.RunSync();
+            }
+            return 0;
+        }
+        
+        DataSyncManager syncer(config, fullSync, ignoreTables, timeBudgetSeconds);
+        if (rebuildHashes) {
+            syncer.RebuildHashes();
+        } else if (daemon) {
+            DataSyncManager::InstallStopHandlers();
+            syncer.RunDaemon();
+        } else {
+            syncer.RunSync();
+        }
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,421 @@
+// ODBC stand-in over SQLite for the tests. It implements the calls the syncer makes,
+// opens the file named by DB= in the connection string and strips the OpenEdge-only
+// parts of the SQL (PUB. qualifiers, WITH (NOLOCK)) before handing it to SQLite.
+#include <sql.h>
+#include <sqlext.h>
+#include <sqlite3.h>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <regex>
+#include <string>
+
+namespace {
+
+struct Diagnostic {
+    std::string state;
+    std::string message;
+};
+
+struct Environment {
+    Diagnostic diagnostic;
+};
+
+struct Connection {
+    sqlite3* db = nullptr;
+    SQLULEN isolation = SQL_TXN_READ_COMMITTED;
+    Diagnostic diagnostic;
+};
+
+struct Parameter {
+    SQLSMALLINT valueType;
+    SQLPOINTER value;
+    SQLLEN bufferLength;
+    SQLLEN* indicator;
+};
+
+struct Statement {
+    Connection* connection = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    std::map<int, Parameter> parameters;
+    SQLULEN paramsetSize = 1;
+    bool done = false;
+    Diagnostic diagnostic;
+};
+
+void SetDiagnostic(Diagnostic& diagnostic, const char* state, const std::string& message) {
+    diagnostic.state = state;
+    diagnostic.message = message;
+}
+
+std::string ToSqlite(std::string sql) {
+    sql = std::regex_replace(sql, std::regex("PUB\\.", std::regex::icase), "");
+    return std::regex_replace(sql, std::regex(" WITH \\(NOLOCK\\)", std::regex::icase), "");
+}
+
+// Binds row `row` of the parameter arrays; a paramset larger than one is column-wise
+void BindParameters(Statement* statement, SQLULEN row) {
+    for (const auto& entry : statement->parameters) {
+        int index = entry.first;
+        const Parameter& param = entry.second;
+        SQLLEN* indicator = param.indicator ? param.indicator + row : nullptr;
+
+        if (indicator && *indicator == SQL_NULL_DATA) {
+            sqlite3_bind_null(statement->stmt, index);
+        } else if (param.valueType == SQL_C_CHAR) {
+            const char* text = static_cast<const char*>(param.value) +
+                               row * (statement->paramsetSize > 1 ? param.bufferLength : 0);
+            int length = (indicator && *indicator != SQL_NTS) ? static_cast<int>(*indicator) : static_cast<int>(strlen(text));
+            sqlite3_bind_text(statement->stmt, index, text, length, SQLITE_TRANSIENT);
+        } else if (param.valueType == SQL_C_SBIGINT) {
+            sqlite3_bind_int64(statement->stmt, index, static_cast<SQLBIGINT*>(param.value)[row]);
+        } else if (param.valueType == SQL_C_SLONG) {
+            sqlite3_bind_int(statement->stmt, index, static_cast<SQLINTEGER*>(param.value)[row]);
+        } else if (param.valueType == SQL_C_DOUBLE) {
+            sqlite3_bind_double(statement->stmt, index, static_cast<SQLDOUBLE*>(param.value)[row]);
+        } else if (param.valueType == SQL_C_TYPE_DATE) {
+            const SQL_DATE_STRUCT* date = static_cast<SQL_DATE_STRUCT*>(param.value) + row;
+            char text[32];
+            snprintf(text, sizeof(text), "%04d-%02u-%02u", date->year, date->month, date->day);
+            sqlite3_bind_text(statement->stmt, index, text, -1, SQLITE_TRANSIENT);
+        } else if (param.valueType == SQL_C_TYPE_TIMESTAMP) {
+            const SQL_TIMESTAMP_STRUCT* ts = static_cast<SQL_TIMESTAMP_STRUCT*>(param.value) + row;
+            char text[64];
+            if (ts->fraction) {
+                snprintf(text, sizeof(text), "%04d-%02u-%02u %02u:%02u:%02u.%03u", ts->year, ts->month, ts->day,
+                         ts->hour, ts->minute, ts->second, ts->fraction / 1000000);
+            } else {
+                snprintf(text, sizeof(text), "%04d-%02u-%02u %02u:%02u:%02u", ts->year, ts->month, ts->day,
+                         ts->hour, ts->minute, ts->second);
+            }
+            sqlite3_bind_text(statement->stmt, index, text, -1, SQLITE_TRANSIENT);
+        }
+    }
+}
+
+SQLSMALLINT ToSqlType(const char* declaredType) {
+    std::string type = declaredType ? declaredType : "";
+    for (auto& c : type) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    if (type.find("INT") != std::string::npos) {
+        return SQL_INTEGER;
+    } else if (type.find("TIMESTAMP") != std::string::npos) {
+        return SQL_TYPE_TIMESTAMP;
+    } else if (type.find("DATE") != std::string::npos) {
+        return SQL_TYPE_DATE;
+    } else if (type.find("REAL") != std::string::npos || type.find("DEC") != std::string::npos) {
+        return SQL_DECIMAL;
+    }
+    return SQL_VARCHAR;
+}
+
+SQLRETURN RunCatalogQuery(SQLHSTMT handle, const std::string& sql) {
+    SQLRETURN ret = SQLPrepare(handle, (SQLCHAR*)sql.c_str(), SQL_NTS);
+    return SQL_SUCCEEDED(ret) ? SQLExecute(handle) : ret;
+}
+
+} // namespace
+
+extern "C" {
+
+SQLRETURN SQLAllocHandle(SQLSMALLINT handleType, SQLHANDLE inputHandle, SQLHANDLE* outputHandle) {
+    if (handleType == SQL_HANDLE_ENV) {
+        *outputHandle = new Environment;
+        return SQL_SUCCESS;
+    } else if (handleType == SQL_HANDLE_DBC) {
+        *outputHandle = new Connection;
+        return SQL_SUCCESS;
+    } else if (handleType == SQL_HANDLE_STMT) {
+        Connection* connection = static_cast<Connection*>(inputHandle);
+        if (!connection->db) {
+            SetDiagnostic(connection->diagnostic, "08003", "Connection not open");
+            return SQL_ERROR;
+        }
+        Statement* statement = new Statement;
+        statement->connection = connection;
+        *outputHandle = statement;
+        return SQL_SUCCESS;
+    }
+    return SQL_ERROR;
+}
+
+SQLRETURN SQLFreeHandle(SQLSMALLINT handleType, SQLHANDLE handle) {
+    if (handleType == SQL_HANDLE_STMT) {
+        Statement* statement = static_cast<Statement*>(handle);
+        sqlite3_finalize(statement->stmt);
+        delete statement;
+    } else if (handleType == SQL_HANDLE_DBC) {
+        delete static_cast<Connection*>(handle);
+    } else if (handleType == SQL_HANDLE_ENV) {
+        delete static_cast<Environment*>(handle);
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLSetEnvAttr(SQLHENV, SQLINTEGER, SQLPOINTER, SQLINTEGER) {
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLSetConnectAttr(SQLHDBC handle, SQLINTEGER attribute, SQLPOINTER value, SQLINTEGER) {
+    if (attribute == SQL_ATTR_TXN_ISOLATION) {
+        static_cast<Connection*>(handle)->isolation = reinterpret_cast<SQLULEN>(value);
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLGetConnectAttr(SQLHDBC handle, SQLINTEGER attribute, SQLPOINTER value, SQLINTEGER, SQLINTEGER*) {
+    Connection* connection = static_cast<Connection*>(handle);
+    if (attribute == SQL_ATTR_CONNECTION_DEAD) {
+        *static_cast<SQLUINTEGER*>(value) = connection->db ? SQL_CD_FALSE : SQL_CD_TRUE;
+    } else if (attribute == SQL_ATTR_TXN_ISOLATION) {
+        *static_cast<SQLUINTEGER*>(value) = static_cast<SQLUINTEGER>(connection->isolation);
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLSetStmtAttr(SQLHSTMT handle, SQLINTEGER attribute, SQLPOINTER value, SQLINTEGER) {
+    if (attribute == SQL_ATTR_PARAMSET_SIZE) {
+        static_cast<Statement*>(handle)->paramsetSize = reinterpret_cast<SQLULEN>(value);
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLDriverConnect(SQLHDBC handle, SQLHWND, SQLCHAR* inConnectionString, SQLSMALLINT, SQLCHAR*, SQLSMALLINT,
+                           SQLSMALLINT*, SQLUSMALLINT) {
+    Connection* connection = static_cast<Connection*>(handle);
+    std::string connectionString = ";" + std::string((char*)inConnectionString);
+
+    size_t start = connectionString.find(";DB=");
+    if (start == std::string::npos) {
+        SetDiagnostic(connection->diagnostic, "08001", "Connection string has no DB= entry");
+        return SQL_ERROR;
+    }
+    start += 4;
+    std::string path = connectionString.substr(start, connectionString.find(';', start) - start);
+
+    if (sqlite3_open(path.c_str(), &connection->db) != SQLITE_OK) {
+        SetDiagnostic(connection->diagnostic, "08001", "Cannot open " + path);
+        sqlite3_close(connection->db);
+        connection->db = nullptr;
+        return SQL_ERROR;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLDisconnect(SQLHDBC handle) {
+    Connection* connection = static_cast<Connection*>(handle);
+    sqlite3_close(connection->db);
+    connection->db = nullptr;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLGetInfo(SQLHDBC, SQLUSMALLINT infoType, SQLPOINTER value, SQLSMALLINT, SQLSMALLINT*) {
+    // Zero means no limit for the numeric limits the syncer asks for
+    if (infoType == SQL_MAX_STATEMENT_LEN) {
+        *static_cast<SQLUINTEGER*>(value) = 0;
+    } else {
+        *static_cast<SQLUSMALLINT*>(value) = 0;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLEndTran(SQLSMALLINT, SQLHANDLE, SQLSMALLINT) {
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLPrepare(SQLHSTMT handle, SQLCHAR* statementText, SQLINTEGER) {
+    Statement* statement = static_cast<Statement*>(handle);
+    std::string sql = ToSqlite((char*)statementText);
+
+    sqlite3_finalize(statement->stmt);
+    statement->stmt = nullptr;
+    if (sqlite3_prepare_v2(statement->connection->db, sql.c_str(), -1, &statement->stmt, nullptr) != SQLITE_OK) {
+        SetDiagnostic(statement->diagnostic, "42000", std::string(sqlite3_errmsg(statement->connection->db)) +
+                      " in " + sql);
+        return SQL_ERROR;
+    }
+    statement->done = false;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLExecute(SQLHSTMT handle) {
+    Statement* statement = static_cast<Statement*>(handle);
+    sqlite3_reset(statement->stmt);
+    BindParameters(statement, 0);
+    statement->done = false;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLExecDirect(SQLHSTMT handle, SQLCHAR* statementText, SQLINTEGER textLength) {
+    SQLRETURN ret = SQLPrepare(handle, statementText, textLength);
+    return SQL_SUCCEEDED(ret) ? SQLExecute(handle) : ret;
+}
+
+SQLRETURN SQLBindParameter(SQLHSTMT handle, SQLUSMALLINT parameterNumber, SQLSMALLINT, SQLSMALLINT valueType,
+                           SQLSMALLINT, SQLULEN, SQLSMALLINT, SQLPOINTER value, SQLLEN bufferLength,
+                           SQLLEN* indicator) {
+    static_cast<Statement*>(handle)->parameters[parameterNumber] = Parameter{valueType, value, bufferLength, indicator};
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLFetch(SQLHSTMT handle) {
+    Statement* statement = static_cast<Statement*>(handle);
+    if (!statement->stmt || statement->done) {
+        return SQL_NO_DATA;
+    }
+
+    int rc = sqlite3_step(statement->stmt);
+    if (rc == SQLITE_ROW) {
+        return SQL_SUCCESS;
+    }
+
+    statement->done = true;
+    if (rc == SQLITE_DONE) {
+        return SQL_NO_DATA;
+    }
+    SetDiagnostic(statement->diagnostic, "HY000", sqlite3_errmsg(statement->connection->db));
+    return SQL_ERROR;
+}
+
+SQLRETURN SQLCloseCursor(SQLHSTMT handle) {
+    Statement* statement = static_cast<Statement*>(handle);
+    sqlite3_reset(statement->stmt);
+    statement->done = true;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLFreeStmt(SQLHSTMT handle, SQLUSMALLINT option) {
+    if (option == SQL_RESET_PARAMS) {
+        static_cast<Statement*>(handle)->parameters.clear();
+    } else if (option == SQL_CLOSE) {
+        SQLCloseCursor(handle);
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLMoreResults(SQLHSTMT) {
+    return SQL_NO_DATA;
+}
+
+// Everything is read with SQLGetData
+SQLRETURN SQLBindCol(SQLHSTMT handle, SQLUSMALLINT, SQLSMALLINT, SQLPOINTER, SQLLEN, SQLLEN*) {
+    SetDiagnostic(static_cast<Statement*>(handle)->diagnostic, "HYC00", "Column binding is not supported");
+    return SQL_ERROR;
+}
+
+SQLRETURN SQLGetData(SQLHSTMT handle, SQLUSMALLINT columnNumber, SQLSMALLINT targetType, SQLPOINTER targetValue,
+                     SQLLEN bufferLength, SQLLEN* indicator) {
+    Statement* statement = static_cast<Statement*>(handle);
+    int column = columnNumber - 1;
+
+    if (sqlite3_column_type(statement->stmt, column) == SQLITE_NULL) {
+        *indicator = SQL_NULL_DATA;
+        return SQL_SUCCESS;
+    }
+
+    if (targetType == SQL_C_SBIGINT) {
+        *static_cast<SQLBIGINT*>(targetValue) = sqlite3_column_int64(statement->stmt, column);
+        *indicator = sizeof(SQLBIGINT);
+        return SQL_SUCCESS;
+    }
+
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(statement->stmt, column));
+    SQLLEN length = static_cast<SQLLEN>(strlen(text));
+    SQLLEN copied = length < bufferLength - 1 ? length : bufferLength - 1;
+    memcpy(targetValue, text, copied);
+    static_cast<char*>(targetValue)[copied] = '\0';
+    *indicator = length;
+    return length > copied ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+}
+
+SQLRETURN SQLNumResultCols(SQLHSTMT handle, SQLSMALLINT* columnCount) {
+    Statement* statement = static_cast<Statement*>(handle);
+    *columnCount = statement->stmt ? static_cast<SQLSMALLINT>(sqlite3_column_count(statement->stmt)) : 0;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLDescribeCol(SQLHSTMT handle, SQLUSMALLINT columnNumber, SQLCHAR* columnName, SQLSMALLINT bufferLength,
+                         SQLSMALLINT* nameLength, SQLSMALLINT* dataType, SQLULEN* columnSize,
+                         SQLSMALLINT* decimalDigits, SQLSMALLINT* nullable) {
+    Statement* statement = static_cast<Statement*>(handle);
+    int column = columnNumber - 1;
+
+    snprintf((char*)columnName, bufferLength, "%s", sqlite3_column_name(statement->stmt, column));
+    *nameLength = static_cast<SQLSMALLINT>(strlen((char*)columnName));
+    *dataType = ToSqlType(sqlite3_column_decltype(statement->stmt, column));
+    *columnSize = 50;
+    if (decimalDigits) {
+        *decimalDigits = 0;
+    }
+
+    if (nullable) {
+        int notNull = 0;
+        const char* table = sqlite3_column_table_name(statement->stmt, column);
+        const char* origin = sqlite3_column_origin_name(statement->stmt, column);
+        if (table && origin) {
+            sqlite3_table_column_metadata(statement->connection->db, nullptr, table, origin, nullptr, nullptr,
+                                          &notNull, nullptr, nullptr);
+        }
+        *nullable = notNull ? SQL_NO_NULLS : SQL_NULLABLE;
+    }
+    return SQL_SUCCESS;
+}
+
+// Catalog functions answer from sqlite_master and the table pragmas, every table in schema PUB
+SQLRETURN SQLTables(SQLHSTMT handle, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT,
+                    SQLCHAR*, SQLSMALLINT) {
+    return RunCatalogQuery(handle,
+        "SELECT NULL, 'PUB', name, 'TABLE', NULL FROM sqlite_master "
+        "WHERE type = 'table' AND name NOT LIKE 'sqlite_%' ORDER BY name");
+}
+
+SQLRETURN SQLPrimaryKeys(SQLHSTMT handle, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT, SQLCHAR* tableName,
+                         SQLSMALLINT) {
+    std::string table((char*)tableName);
+    return RunCatalogQuery(handle,
+        "SELECT NULL, 'PUB', '" + table + "', name, pk, 'pk' FROM pragma_table_info('" + table + "') "
+        "WHERE pk > 0 ORDER BY pk");
+}
+
+SQLRETURN SQLStatistics(SQLHSTMT handle, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT, SQLCHAR* tableName,
+                        SQLSMALLINT, SQLUSMALLINT unique, SQLUSMALLINT) {
+    std::string table((char*)tableName);
+    return RunCatalogQuery(handle,
+        "SELECT NULL, 'PUB', '" + table + "', NULL, NULL, NULL, 0, NULL, NULL, NULL, "
+        "(SELECT COUNT(*) FROM \"" + table + "\"), NULL, NULL "
+        "UNION ALL SELECT NULL, 'PUB', '" + table + "', NOT il.\"unique\", NULL, il.name, 3, ii.seqno + 1, "
+        "ii.name, 'A', NULL, NULL, NULL "
+        "FROM pragma_index_list('" + table + "') il, pragma_index_info(il.name) ii" +
+        (unique == SQL_INDEX_UNIQUE ? " WHERE il.\"unique\"" : ""));
+}
+
+SQLRETURN SQLColumns(SQLHSTMT handle, SQLCHAR*, SQLSMALLINT, SQLCHAR*, SQLSMALLINT, SQLCHAR* tableName,
+                     SQLSMALLINT, SQLCHAR*, SQLSMALLINT) {
+    std::string table((char*)tableName);
+    return RunCatalogQuery(handle,
+        "SELECT NULL, 'PUB', '" + table + "', name, 12, type, 50, 50, 0, 10, "
+        "CASE WHEN \"notnull\" THEN 0 ELSE 1 END, NULL, NULL, 12, NULL, NULL, cid + 1, "
+        "CASE WHEN \"notnull\" THEN 'NO' ELSE 'YES' END FROM pragma_table_info('" + table + "')");
+}
+
+SQLRETURN SQLGetDiagRec(SQLSMALLINT handleType, SQLHANDLE handle, SQLSMALLINT recNumber, SQLCHAR* sqlState,
+                        SQLINTEGER* nativeError, SQLCHAR* messageText, SQLSMALLINT bufferLength,
+                        SQLSMALLINT* textLength) {
+    const Diagnostic* diagnostic = handleType == SQL_HANDLE_STMT ? &static_cast<Statement*>(handle)->diagnostic :
+                                   handleType == SQL_HANDLE_DBC ? &static_cast<Connection*>(handle)->diagnostic :
+                                   &static_cast<Environment*>(handle)->diagnostic;
+    if (recNumber != 1 || diagnostic->state.empty()) {
+        return SQL_NO_DATA;
+    }
+
+    snprintf((char*)sqlState, 6, "%s", diagnostic->state.c_str());
+    *nativeError = 0;
+    snprintf((char*)messageText, bufferLength, "%s", diagnostic->message.c_str());
+    *textLength = static_cast<SQLSMALLINT>(strlen((char*)messageText));
+    return SQL_SUCCESS;
+}
+
+}